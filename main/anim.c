@@ -0,0 +1,250 @@
+#include "anim.h"
+#include <string.h>
+#include "esp_log.h"
+#include "trace.h"
+
+static const char *TAG = "anim";
+
+// Catch-up limit after a long stall, so a slow frame cannot trigger a burst of steps
+#define ANIM_MAX_CATCHUP_NS (250 * SDL_NS_PER_MS)
+
+static float ease(anim_ease_t kind, float t) {
+    switch (kind) {
+        case ANIM_EASE_OUT_CUBIC: {
+            float u = 1.0f - t;
+            return 1.0f - u * u * u;
+        }
+        case ANIM_EASE_LINEAR:
+        default:
+            return t;
+    }
+}
+
+void anim_tween_start(anim_tween_t *tween, float from, float to, Uint64 duration_ns, anim_ease_t kind) {
+    tween->from = from;
+    tween->to = to;
+    tween->value = from;
+    tween->elapsed_ns = 0;
+    tween->duration_ns = duration_ns;
+    tween->ease = kind;
+    tween->active = duration_ns > 0;
+    if (!tween->active) {
+        tween->value = to;
+    }
+}
+
+void anim_tween_step(anim_tween_t *tween, Uint64 dt_ns) {
+    if (!tween->active) {
+        return;
+    }
+    tween->elapsed_ns += dt_ns;
+    if (tween->elapsed_ns >= tween->duration_ns) {
+        tween->value = tween->to;
+        tween->active = false;
+        return;
+    }
+    float t = (float)tween->elapsed_ns / (float)tween->duration_ns;
+    tween->value = tween->from + (tween->to - tween->from) * ease(tween->ease, t);
+}
+
+void anim_init(anim_engine_t *anim, SDL_Renderer *renderer, TTF_Font *font, int width, int height, Uint64 budget_ns) {
+    memset(anim, 0, sizeof(*anim));
+    anim->renderer = renderer;
+    anim->font = font;
+    anim->width = width;
+    anim->height = height;
+    anim->page = WEATHER_PAGE_CURRENT;
+
+#ifdef DISPLAY_EPAPER
+    // Partial e-paper refreshes are slower than any transition; draw final frames only
+    anim_budget_init(&anim->budget, budget_ns, ANIM_QUALITY_OFF);
+#else
+    anim->cached = true;
+    for (int i = 0; i < ANIM_LAYER_COUNT; i++) {
+        anim->layers[i].texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGB565, SDL_TEXTUREACCESS_TARGET,
+                                                    width, height);
+        if (anim->layers[i].texture == NULL) {
+            ESP_LOGW(TAG, "No layer cache (%s), animations disabled", SDL_GetError());
+            anim->cached = false;
+            break;
+        }
+    }
+    if (!anim->cached) {
+        for (int i = 0; i < ANIM_LAYER_COUNT; i++) {
+            if (anim->layers[i].texture != NULL) {
+                SDL_DestroyTexture(anim->layers[i].texture);
+                anim->layers[i].texture = NULL;
+            }
+        }
+    }
+    anim_budget_init(&anim->budget, budget_ns, anim->cached ? ANIM_QUALITY_FULL : ANIM_QUALITY_OFF);
+#endif
+}
+
+// Weather data changed: every cached layer must be rasterized again
+void anim_invalidate(anim_engine_t *anim) {
+    for (int i = 0; i < ANIM_LAYER_COUNT; i++) {
+        anim->layers[i].valid = false;
+    }
+}
+
+// Cached layer of a page, rasterized on first use. A slot already used by
+// this frame is never evicted, so both sides of a transition stay cached.
+static SDL_Texture *layer(anim_engine_t *anim, int page, bool detail) {
+    if (!anim->cached) {
+        return NULL;
+    }
+
+    anim_layer_t *slot = NULL;
+    for (int i = 0; i < ANIM_LAYER_COUNT; i++) {
+        anim_layer_t *candidate = &anim->layers[i];
+        if (candidate->valid && candidate->page == page && candidate->detail == detail) {
+            slot = candidate;
+            break;
+        }
+    }
+
+    if (slot == NULL) {
+        for (int i = 0; i < ANIM_LAYER_COUNT; i++) {
+            anim_layer_t *candidate = &anim->layers[i];
+            if (candidate->used == anim->frame) {
+                continue;
+            }
+            if (slot == NULL || (slot->valid && !candidate->valid) ||
+                (slot->valid == candidate->valid && candidate->used < slot->used)) {
+                slot = candidate;
+            }
+        }
+
+        TRACE_BEGIN("rasterize_layer");
+        SDL_SetRenderTarget(anim->renderer, slot->texture);
+        draw_weather_page(anim->renderer, anim->font, page, detail);
+        SDL_SetRenderTarget(anim->renderer, NULL);
+        TRACE_END("rasterize_layer");
+        slot->page = page;
+        slot->detail = detail;
+        slot->valid = true;
+    }
+
+    slot->used = anim->frame;
+    return slot->texture;
+}
+
+// Request a page; starts a slide for a page change or a fade for a detail toggle
+void anim_show(anim_engine_t *anim, int page, bool detail, int direction, Uint64 now_ns) {
+    if (page == anim->page && detail == anim->detail) {
+        return;
+    }
+
+    anim->from_page = anim->page;
+    anim->from_detail = anim->detail;
+    anim->page = page;
+    anim->detail = detail;
+    anim->direction = direction < 0 ? -1 : 1;
+    anim->accumulator_ns = 0;
+    anim->last_ns = now_ns;
+    anim->transition_start_ns = now_ns;
+    anim_budget_reset_window(&anim->budget);
+
+    if (anim->budget.quality == ANIM_QUALITY_OFF) {
+        anim->transition = ANIM_TRANSITION_NONE;
+    } else if (page != anim->from_page) {
+        anim->transition = ANIM_TRANSITION_SLIDE;
+        anim_tween_start(&anim->tween, 0.0f, 1.0f, ANIM_SLIDE_NS, ANIM_EASE_OUT_CUBIC);
+    } else if (anim->budget.quality == ANIM_QUALITY_FULL) {
+        anim->transition = ANIM_TRANSITION_FADE;
+        anim_tween_start(&anim->tween, 0.0f, 1.0f, ANIM_FADE_NS, ANIM_EASE_LINEAR);
+    } else {
+        anim->transition = ANIM_TRANSITION_NONE;
+    }
+}
+
+bool anim_active(const anim_engine_t *anim) {
+    return anim->transition != ANIM_TRANSITION_NONE;
+}
+
+static void log_transition(anim_engine_t *anim, Uint64 now_ns) {
+    const anim_budget_t *budget = &anim->budget;
+    if (budget->frame_count == 0) {
+        return;
+    }
+
+    double seconds = (double)(now_ns - anim->transition_start_ns) / SDL_NS_PER_SECOND;
+    ESP_LOGI(TAG, "Transition: %d frames, %.1f fps, frame time p50 %u us, p95 %u us, p99 %u us, quality %d",
+             budget->frame_count, seconds > 0 ? budget->frame_count / seconds : 0.0,
+             (unsigned)anim_budget_percentile_us(budget, 50), (unsigned)anim_budget_percentile_us(budget, 95),
+             (unsigned)anim_budget_percentile_us(budget, 99), budget->quality);
+}
+
+// Advance the simulation in fixed steps and composite one frame
+void anim_frame(anim_engine_t *anim, Uint64 now_ns) {
+    Uint64 elapsed = now_ns > anim->last_ns ? now_ns - anim->last_ns : 0;
+    anim->last_ns = now_ns;
+    anim->accumulator_ns += elapsed < ANIM_MAX_CATCHUP_NS ? elapsed : ANIM_MAX_CATCHUP_NS;
+    while (anim->accumulator_ns >= ANIM_STEP_NS) {
+        anim_tween_step(&anim->tween, ANIM_STEP_NS);
+        anim->accumulator_ns -= ANIM_STEP_NS;
+    }
+
+    // Quality may have dropped mid-transition
+    if (anim->transition == ANIM_TRANSITION_FADE && anim->budget.quality < ANIM_QUALITY_FULL) {
+        anim->tween.active = false;
+    }
+    if (anim->budget.quality == ANIM_QUALITY_OFF) {
+        anim->tween.active = false;
+    }
+
+    // Rasterize before the timed window: text rendering after a weather update
+    // or for a page not shown before says nothing about compositing cost
+    anim->frame++;
+    SDL_Texture *to = layer(anim, anim->page, anim->detail);
+    SDL_Texture *from = NULL;
+    if (to != NULL && anim->tween.active) {
+        from = layer(anim, anim->from_page, anim->from_detail);
+    }
+
+    Uint64 start_ns = SDL_GetTicksNS();
+    if (to == NULL) {
+        // No layer cache: draw straight to the screen
+        draw_weather_page(anim->renderer, anim->font, anim->page, anim->detail);
+        anim->transition = ANIM_TRANSITION_NONE;
+    } else if (from != NULL && anim->transition == ANIM_TRANSITION_SLIDE) {
+        TRACE_BEGIN("composite");
+        float offset = anim->tween.value * anim->width * anim->direction;
+        SDL_FRect from_rect = {-offset, 0.0f, (float)anim->width, (float)anim->height};
+        SDL_FRect to_rect = {anim->direction * anim->width - offset, 0.0f, (float)anim->width, (float)anim->height};
+        SDL_SetTextureBlendMode(to, SDL_BLENDMODE_NONE);
+        SDL_SetTextureBlendMode(from, SDL_BLENDMODE_NONE);
+        SDL_RenderTexture(anim->renderer, from, NULL, &from_rect);
+        SDL_RenderTexture(anim->renderer, to, NULL, &to_rect);
+        TRACE_END("composite");
+    } else if (from != NULL && anim->transition == ANIM_TRANSITION_FADE) {
+        // Both detail variants are cached: blend the new one over the old one
+        TRACE_BEGIN("composite");
+        SDL_SetTextureBlendMode(from, SDL_BLENDMODE_NONE);
+        SDL_RenderTexture(anim->renderer, from, NULL, NULL);
+        SDL_SetTextureBlendMode(to, SDL_BLENDMODE_BLEND);
+        SDL_SetTextureAlphaMod(to, (Uint8)(anim->tween.value * 255.0f));
+        SDL_RenderTexture(anim->renderer, to, NULL, NULL);
+        SDL_SetTextureAlphaMod(to, 255);
+        TRACE_END("composite");
+    } else {
+        SDL_SetTextureBlendMode(to, SDL_BLENDMODE_NONE);
+        SDL_RenderTexture(anim->renderer, to, NULL, NULL);
+    }
+
+    // Only compositing is timed. The transfer to the panel in present is set
+    // by the bus clock on SPI panels, and counting it would hold quality at OFF.
+    SDL_FlushRenderer(anim->renderer);
+    Uint64 frame_ns = SDL_GetTicksNS() - start_ns;
+
+    TRACE_BEGIN("present");
+    SDL_RenderPresent(anim->renderer);
+    TRACE_END("present");
+
+    anim_budget_account(&anim->budget, frame_ns, now_ns);
+    if (anim->transition != ANIM_TRANSITION_NONE && !anim->tween.active) {
+        log_transition(anim, now_ns);
+        anim->transition = ANIM_TRANSITION_NONE;
+    }
+}
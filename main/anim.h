@@ -0,0 +1,79 @@
+#ifndef ANIM_H
+#define ANIM_H
+
+#include <stdbool.h>
+#include "SDL3/SDL.h"
+#include "SDL3_ttf/SDL_ttf.h"
+#include "graphics.h"
+#include "anim_budget.h"
+
+#define ANIM_STEP_NS       (SDL_NS_PER_SECOND / 120)  // Fixed simulation step
+#define ANIM_SLIDE_NS      (250 * SDL_NS_PER_MS)
+#define ANIM_FADE_NS       (150 * SDL_NS_PER_MS)
+#define ANIM_LAYER_COUNT   (WEATHER_PAGE_COUNT + 1)  // Every page plus the other detail variant of a fade
+
+typedef enum {
+    ANIM_EASE_LINEAR,
+    ANIM_EASE_OUT_CUBIC,
+} anim_ease_t;
+
+typedef struct {
+    float from;
+    float to;
+    float value;
+    Uint64 elapsed_ns;
+    Uint64 duration_ns;
+    anim_ease_t ease;
+    bool active;
+} anim_tween_t;
+
+typedef enum {
+    ANIM_TRANSITION_NONE,
+    ANIM_TRANSITION_SLIDE,
+    ANIM_TRANSITION_FADE,
+} anim_transition_t;
+
+// One rasterized page; slots are reused least recently used first
+typedef struct {
+    SDL_Texture *texture;
+    int page;
+    bool detail;
+    bool valid;
+    Uint64 used;         // Frame that last used the layer
+} anim_layer_t;
+
+typedef struct {
+    SDL_Renderer *renderer;
+    TTF_Font *font;
+    int width;
+    int height;
+
+    // Cached page layers; text is rasterized once per page and detail, not per frame
+    anim_layer_t layers[ANIM_LAYER_COUNT];
+    bool cached;
+    Uint64 frame;
+
+    int page;            // Page being shown (target of the running transition)
+    bool detail;
+    int from_page;
+    bool from_detail;
+    int direction;       // +1 slides in from the right, -1 from the left
+    anim_transition_t transition;
+    anim_tween_t tween;
+
+    Uint64 last_ns;
+    Uint64 accumulator_ns;
+    anim_budget_t budget;
+    Uint64 transition_start_ns;
+} anim_engine_t;
+
+void anim_tween_start(anim_tween_t *tween, float from, float to, Uint64 duration_ns, anim_ease_t ease);
+void anim_tween_step(anim_tween_t *tween, Uint64 dt_ns);
+
+void anim_init(anim_engine_t *anim, SDL_Renderer *renderer, TTF_Font *font, int width, int height, Uint64 budget_ns);
+void anim_invalidate(anim_engine_t *anim);
+void anim_show(anim_engine_t *anim, int page, bool detail, int direction, Uint64 now_ns);
+bool anim_active(const anim_engine_t *anim);
+void anim_frame(anim_engine_t *anim, Uint64 now_ns);
+
+#endif // ANIM_H
@@ -0,0 +1,56 @@
+#include "anim_budget.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "anim";
+
+void anim_budget_init(anim_budget_t *budget, uint64_t budget_ns, anim_quality_t max_quality) {
+    memset(budget, 0, sizeof(*budget));
+    budget->budget_ns = budget_ns;
+    budget->quality = max_quality;
+    budget->max_quality = max_quality;
+}
+
+// Adjust quality to the measured cost of the frame just presented
+void anim_budget_account(anim_budget_t *budget, uint64_t frame_ns, uint64_t now_ns) {
+    budget->frame_us[budget->frame_count % ANIM_FRAME_HISTORY] = (uint32_t)(frame_ns / 1000);
+    budget->frame_count++;
+
+    if (frame_ns > budget->budget_ns) {
+        budget->calm_since_ns = now_ns;
+        if (budget->quality > ANIM_QUALITY_OFF) {
+            budget->quality--;
+            ESP_LOGW(TAG, "Frame took %u us, lowering animation quality to %d",
+                     (unsigned)(frame_ns / 1000), budget->quality);
+        }
+    } else if (budget->quality < budget->max_quality && now_ns - budget->calm_since_ns >= ANIM_RECOVER_NS) {
+        budget->calm_since_ns = now_ns;
+        budget->quality++;
+        ESP_LOGI(TAG, "No overrun for %u ms, raising animation quality to %d",
+                 (unsigned)(ANIM_RECOVER_NS / 1000000), budget->quality);
+    }
+}
+
+// Start a new window for the frame time percentiles; quality state is kept
+void anim_budget_reset_window(anim_budget_t *budget) {
+    budget->frame_count = 0;
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Frame time percentile over the last ANIM_FRAME_HISTORY frames of the window
+uint32_t anim_budget_percentile_us(const anim_budget_t *budget, int percent) {
+    int count = budget->frame_count < ANIM_FRAME_HISTORY ? budget->frame_count : ANIM_FRAME_HISTORY;
+    if (count == 0) {
+        return 0;
+    }
+    uint32_t sorted[ANIM_FRAME_HISTORY];
+    memcpy(sorted, budget->frame_us, count * sizeof(uint32_t));
+    qsort(sorted, count, sizeof(uint32_t), compare_u32);
+    return sorted[count * percent / 100 < count ? count * percent / 100 : count - 1];
+}
@@ -0,0 +1,36 @@
+#ifndef ANIM_BUDGET_H
+#define ANIM_BUDGET_H
+
+#include <stdint.h>
+
+// Animation quality controller: lowers quality on a frame over budget and
+// raises it one step on the first frame within budget once ANIM_RECOVER_NS
+// passed without an overrun. Recovery goes by time, not by frame count: the
+// loop only presents on input, so at OFF a count of good frames would take as
+// many inputs. Free of SDL so it is tested on the host.
+#define ANIM_RECOVER_NS    2000000000ull  // Time without overruns before quality goes back up
+#define ANIM_FRAME_HISTORY 128            // Frame times kept for percentiles
+
+typedef enum {
+    ANIM_QUALITY_OFF,      // Snap to the final frame
+    ANIM_QUALITY_REDUCED,  // Slides only, no alpha blending
+    ANIM_QUALITY_FULL,     // Slides and fades
+} anim_quality_t;
+
+typedef struct {
+    uint64_t budget_ns;
+    anim_quality_t quality;
+    anim_quality_t max_quality;  // OFF without a layer cache or on e-paper
+    uint64_t calm_since_ns;      // Last overrun or quality change
+
+    // Frame times of the current measurement window, e.g. one transition
+    uint32_t frame_us[ANIM_FRAME_HISTORY];
+    int frame_count;
+} anim_budget_t;
+
+void anim_budget_init(anim_budget_t *budget, uint64_t budget_ns, anim_quality_t max_quality);
+void anim_budget_account(anim_budget_t *budget, uint64_t frame_ns, uint64_t now_ns);
+void anim_budget_reset_window(anim_budget_t *budget);
+uint32_t anim_budget_percentile_us(const anim_budget_t *budget, int percent);
+
+#endif // ANIM_BUDGET_H
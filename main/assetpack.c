@@ -0,0 +1,229 @@
+#include "assetpack.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_partition.h"
+
+static const char *TAG = "assetpack";
+
+_Static_assert(sizeof(assetpack_header_t) == 32, "asset pack header layout");
+_Static_assert(sizeof(assetpack_entry_t) == 48, "asset pack entry layout");
+
+static const uint8_t *s_base;
+static const assetpack_header_t *s_header;
+static const assetpack_entry_t *s_index;
+static esp_partition_mmap_handle_t s_mmap_handle;
+
+// Map the "assets" partition once and validate the index. No per-file work
+// happens at boot beyond bounds checks on the index entries.
+esp_err_t assetpack_init(void) {
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                                ESP_PARTITION_SUBTYPE_ANY, "assets");
+    if (partition == NULL) {
+        ESP_LOGE(TAG, "Partition \"assets\" not found");
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const void *mapped = NULL;
+    esp_err_t err = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA,
+                                       &mapped, &s_mmap_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to map assets partition: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    // Bounds are checked by subtraction so that no sum can wrap around
+    const assetpack_header_t *header = mapped;
+    if (memcmp(header->magic, ASSETPACK_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != ASSETPACK_VERSION ||
+        header->total_size > partition->size ||
+        header->index_offset > header->total_size ||
+        header->entry_count > (header->total_size - header->index_offset) / sizeof(assetpack_entry_t)) {
+        ESP_LOGE(TAG, "Invalid asset pack header");
+        esp_partition_munmap(s_mmap_handle);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    const assetpack_entry_t *index = (const assetpack_entry_t *)((const uint8_t *)mapped + header->index_offset);
+    for (int i = 0; i < header->entry_count; i++) {
+        const assetpack_entry_t *entry = &index[i];
+        if (entry->name[ASSETPACK_NAME_MAX - 1] != '\0' ||
+            entry->offset > header->total_size ||
+            entry->size > header->total_size - entry->offset ||
+            (!(entry->flags & ASSETPACK_FLAG_LZ4) && entry->size != entry->original_size) ||
+            (i > 0 && strncmp(index[i - 1].name, entry->name, ASSETPACK_NAME_MAX) >= 0)) {
+            ESP_LOGE(TAG, "Invalid asset pack entry %d", i);
+            esp_partition_munmap(s_mmap_handle);
+            return ESP_ERR_INVALID_SIZE;
+        }
+    }
+
+    s_base = mapped;
+    s_header = header;
+    s_index = index;
+    ESP_LOGI(TAG, "Asset pack mapped: %d entries, %u bytes", header->entry_count, (unsigned)header->total_size);
+    return ESP_OK;
+}
+
+static int compare_entry(const void *key, const void *element) {
+    const assetpack_entry_t *entry = element;
+    return strncmp(key, entry->name, ASSETPACK_NAME_MAX);
+}
+
+const assetpack_entry_t *assetpack_find(const char *name) {
+    if (s_header == NULL) {
+        return NULL;
+    }
+    return bsearch(name, s_index, s_header->entry_count, sizeof(assetpack_entry_t), compare_entry);
+}
+
+// All entries whose name starts with prefix are adjacent in the sorted index.
+// Returns how many there are and points first at the lowest one.
+int assetpack_find_prefix(const char *prefix, const assetpack_entry_t **first) {
+    size_t prefix_len = strlen(prefix);
+    int low = 0;
+    int high = s_header ? s_header->entry_count : 0;
+
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (strncmp(s_index[mid].name, prefix, ASSETPACK_NAME_MAX) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    int count = 0;
+    while (s_header && low + count < s_header->entry_count &&
+           strncmp(s_index[low + count].name, prefix, prefix_len) == 0) {
+        count++;
+    }
+    *first = count ? &s_index[low] : NULL;
+    return count;
+}
+
+// Zero-copy access to an uncompressed entry inside the mapped partition
+const void *assetpack_get(const char *name, size_t *size) {
+    const assetpack_entry_t *entry = assetpack_find(name);
+    if (entry == NULL || (entry->flags & ASSETPACK_FLAG_LZ4)) {
+        return NULL;
+    }
+    if (size) {
+        *size = entry->size;
+    }
+    return s_base + entry->offset;
+}
+
+// Decode a raw LZ4 block. Returns the decoded size or -1 on malformed input.
+static int lz4_decompress(const uint8_t *src, size_t src_size, uint8_t *dst, size_t dst_size) {
+    const uint8_t *ip = src;
+    const uint8_t *const ip_end = src + src_size;
+    uint8_t *op = dst;
+    uint8_t *const op_end = dst + dst_size;
+
+    while (ip < ip_end) {
+        unsigned token = *ip++;
+
+        size_t literals = token >> 4;
+        if (literals == 15) {
+            uint8_t b;
+            do {
+                if (ip >= ip_end) {
+                    return -1;
+                }
+                b = *ip++;
+                literals += b;
+            } while (b == 255);
+        }
+        if (literals > (size_t)(ip_end - ip) || literals > (size_t)(op_end - op)) {
+            return -1;
+        }
+        memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+
+        // The last sequence carries literals only
+        if (ip == ip_end) {
+            break;
+        }
+
+        if (ip_end - ip < 2) {
+            return -1;
+        }
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - dst)) {
+            return -1;
+        }
+
+        size_t match = (token & 15) + 4;
+        if ((token & 15) == 15) {
+            uint8_t b;
+            do {
+                if (ip >= ip_end) {
+                    return -1;
+                }
+                b = *ip++;
+                match += b;
+            } while (b == 255);
+        }
+        if (match > (size_t)(op_end - op)) {
+            return -1;
+        }
+
+        // Byte copy: source and destination overlap when offset < match
+        const uint8_t *from = op - offset;
+        while (match--) {
+            *op++ = *from++;
+        }
+    }
+
+    return (int)(op - dst);
+}
+
+// Copy (and decompress if needed) an entry into a heap buffer owned by the caller
+void *assetpack_read(const char *name, size_t *size) {
+    const assetpack_entry_t *entry = assetpack_find(name);
+    if (entry == NULL) {
+        ESP_LOGE(TAG, "Asset not found: %s", name);
+        return NULL;
+    }
+
+    uint8_t *buffer = heap_caps_malloc(entry->original_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (buffer == NULL) {
+        buffer = malloc(entry->original_size);
+    }
+    if (buffer == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate %u bytes for %s", (unsigned)entry->original_size, name);
+        return NULL;
+    }
+
+    if (entry->flags & ASSETPACK_FLAG_LZ4) {
+        int decoded = lz4_decompress(s_base + entry->offset, entry->size, buffer, entry->original_size);
+        if (decoded != (int)entry->original_size) {
+            ESP_LOGE(TAG, "Corrupted LZ4 data in %s", name);
+            free(buffer);
+            return NULL;
+        }
+    } else {
+        // Stored entries were checked at init to have size == original_size
+        memcpy(buffer, s_base + entry->offset, entry->original_size);
+    }
+
+    if (size) {
+        *size = entry->original_size;
+    }
+    return buffer;
+}
+
+// Read-only SDL stream straight over flash; compressed entries need assetpack_read
+SDL_IOStream *assetpack_open_io(const char *name) {
+    size_t size = 0;
+    const void *data = assetpack_get(name, &size);
+    if (data == NULL) {
+        SDL_SetError("Asset %s missing or compressed", name);
+        return NULL;
+    }
+    return SDL_IOFromConstMem(data, size);
+}
@@ -0,0 +1,41 @@
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "SDL3/SDL.h"
+
+// On-flash layout, produced by tools/mkassetpack.py. All fields little-endian.
+#define ASSETPACK_MAGIC    "WAPK"
+#define ASSETPACK_VERSION  1
+#define ASSETPACK_NAME_MAX 32
+#define ASSETPACK_FLAG_LZ4 0x0001
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t entry_count;
+    uint32_t index_offset;  // Sorted array of assetpack_entry_t
+    uint32_t data_offset;
+    uint32_t total_size;
+    uint8_t reserved[12];
+} assetpack_header_t;
+
+typedef struct {
+    char name[ASSETPACK_NAME_MAX];  // NUL padded, sorted bytewise
+    uint32_t offset;                // From the start of the pack
+    uint32_t size;                  // Stored size
+    uint32_t original_size;         // Size after decompression
+    uint16_t flags;
+    uint16_t reserved;
+} assetpack_entry_t;
+
+esp_err_t assetpack_init(void);
+const assetpack_entry_t *assetpack_find(const char *name);
+int assetpack_find_prefix(const char *prefix, const assetpack_entry_t **first);
+const void *assetpack_get(const char *name, size_t *size);
+void *assetpack_read(const char *name, size_t *size);
+SDL_IOStream *assetpack_open_io(const char *name);
+
+#endif // ASSETPACK_H
@@ -0,0 +1,102 @@
+#include "console.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_console.h"
+#include "esp_log.h"
+#include "trace.h"
+#include "metrics.h"
+#include "history.h"
+
+static const char *TAG = "console";
+
+// trace [clear] - print the trace ring as Chrome trace JSON, or empty it
+static int cmd_trace(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "clear") == 0) {
+        trace_clear();
+        return 0;
+    }
+    trace_dump_json(stdout);
+    fflush(stdout);
+    return 0;
+}
+
+// metrics - print histograms and counters in Prometheus text format
+static int cmd_metrics(int argc, char **argv) {
+    metrics_dump_prometheus(stdout);
+    fflush(stdout);
+    return 0;
+}
+
+static bool print_sample(const history_sample_t *sample, void *ctx) {
+    printf("%lld,%.2f,%d,%d\n", (long long)sample->time, sample->temperature, sample->pressure, sample->humidity);
+    return true;
+}
+
+// history [hours] - print logged samples of the last hours (default 24) as CSV
+static int cmd_history(int argc, char **argv) {
+    int hours = argc > 1 ? atoi(argv[1]) : 24;
+    if (hours <= 0) {
+        printf("Usage: history [hours]\n");
+        return 1;
+    }
+    time_t now = time(NULL);
+    printf("time,temperature,pressure,humidity\n");
+    esp_err_t err = history_query(now - (time_t)hours * 3600, now, print_sample, NULL);
+    fflush(stdout);
+    return err == ESP_OK ? 0 : 1;
+}
+
+static void register_commands(void) {
+    const esp_console_cmd_t trace_cmd = {
+        .command = "trace",
+        .help = "Dump trace spans as Chrome trace-event JSON ('trace clear' empties the buffer)",
+        .hint = "[clear]",
+        .func = cmd_trace,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&trace_cmd));
+
+    const esp_console_cmd_t metrics_cmd = {
+        .command = "metrics",
+        .help = "Dump latency histograms and health counters in Prometheus text format",
+        .func = cmd_metrics,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&metrics_cmd));
+
+    const esp_console_cmd_t history_cmd = {
+        .command = "history",
+        .help = "Print logged weather samples of the last hours (default 24) as CSV",
+        .hint = "[hours]",
+        .func = cmd_history,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&history_cmd));
+}
+
+// Serial command prompt on whichever console the board is configured for
+esp_err_t console_init(void) {
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = "weather>";
+
+#if defined(CONFIG_ESP_CONSOLE_UART_DEFAULT) || defined(CONFIG_ESP_CONSOLE_UART_CUSTOM)
+    esp_console_dev_uart_config_t hw_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    esp_err_t err = esp_console_new_repl_uart(&hw_config, &repl_config, &repl);
+#elif defined(CONFIG_ESP_CONSOLE_USB_CDC)
+    esp_console_dev_usb_cdc_config_t hw_config = ESP_CONSOLE_DEV_CDC_CONFIG_DEFAULT();
+    esp_err_t err = esp_console_new_repl_usb_cdc(&hw_config, &repl_config, &repl);
+#elif defined(CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG)
+    esp_console_dev_usb_serial_jtag_config_t hw_config = ESP_CONSOLE_DEV_USB_SERIAL_JTAG_CONFIG_DEFAULT();
+    esp_err_t err = esp_console_new_repl_usb_serial_jtag(&hw_config, &repl_config, &repl);
+#else
+    esp_err_t err = ESP_ERR_NOT_SUPPORTED;
+#endif
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create console: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    esp_console_register_help_command();
+    register_commands();
+    return esp_console_start_repl(repl);
+}
@@ -0,0 +1,8 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include "esp_err.h"
+
+esp_err_t console_init(void);
+
+#endif // CONSOLE_H
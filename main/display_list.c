@@ -0,0 +1,125 @@
+#include "display_list.h"
+#include <string.h>
+#include "esp_log.h"
+#include "graphics.h"
+#include "trace.h"
+
+static const char *TAG = "display_list";
+
+void display_list_init(display_list_t *list, TTF_Font *font) {
+    memset(list, 0, sizeof(*list));
+    list->font = font;
+}
+
+void display_list_clear(display_list_t *list) {
+    list->count = 0;
+    list->text_used = 0;
+}
+
+display_list_mark_t display_list_mark(const display_list_t *list) {
+    display_list_mark_t mark = {list->count, list->text_used};
+    return mark;
+}
+
+void display_list_rewind(display_list_t *list, display_list_mark_t mark) {
+    list->count = mark.count;
+    list->text_used = mark.text_used;
+}
+
+static display_command_t *append(display_list_t *list, display_op_t op, SDL_FRect rect, SDL_Color color) {
+    if (list->count >= DISPLAY_LIST_MAX_COMMANDS) {
+        return NULL;
+    }
+    display_command_t *command = &list->commands[list->count++];
+    command->op = op;
+    command->rect = rect;
+    command->color = color;
+    command->text = 0;
+    return command;
+}
+
+// Text is measured now and rasterized on replay, only in the bands it touches
+bool display_list_text(display_list_t *list, float x, float y, const char *text, SDL_Color color, int *w, int *h) {
+    *w = 0;
+    *h = 0;
+    // No font without the asset pack: nothing to draw, nothing to measure
+    if (list->font == NULL || text[0] == '\0') {
+        return true;
+    }
+    if (!TTF_GetStringSize(list->font, text, 0, w, h)) {
+        ESP_LOGW(TAG, "Failed to measure text: %s", SDL_GetError());
+        return true;
+    }
+
+    size_t len = strlen(text) + 1;
+    if (len > DISPLAY_LIST_TEXT_POOL - list->text_used) {
+        return false;
+    }
+    SDL_FRect rect = {x, y, (float)*w, (float)*h};
+    display_command_t *command = append(list, DISPLAY_TEXT, rect, color);
+    if (command == NULL) {
+        return false;
+    }
+    command->text = (uint16_t)list->text_used;
+    memcpy(list->text + list->text_used, text, len);
+    list->text_used += len;
+    return true;
+}
+
+bool display_list_rect(display_list_t *list, display_op_t op, SDL_FRect rect, SDL_Color color) {
+    return append(list, op, rect, color) != NULL;
+}
+
+bool display_list_line(display_list_t *list, float x1, float y1, float x2, float y2, SDL_Color color) {
+    SDL_FRect rect = {x1, y1, x2, y2};
+    return append(list, DISPLAY_LINE, rect, color) != NULL;
+}
+
+static void draw_text(const display_list_t *list, SDL_Renderer *renderer, const display_command_t *command) {
+    SDL_Surface *surface = TTF_RenderText_Blended(list->font, list->text + command->text, 0, command->color);
+    if (surface == NULL) {
+        ESP_LOGE(TAG, "Failed to render text: %s", SDL_GetError());
+        return;
+    }
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_FRect rect = {command->rect.x, command->rect.y, (float)surface->w, (float)surface->h};
+    SDL_RenderTexture(renderer, texture, NULL, &rect);
+    SDL_DestroyTexture(texture);
+    SDL_DestroySurface(surface);
+}
+
+// Replay every command that reaches into the rows being drawn
+void display_list_draw(const display_list_t *list, SDL_Renderer *renderer) {
+    TRACE_BEGIN("display_list");
+    for (int i = 0; i < list->count; i++) {
+        const display_command_t *command = &list->commands[i];
+        const SDL_FRect *rect = &command->rect;
+
+        float top = rect->y;
+        float rows = rect->h;
+        if (command->op == DISPLAY_LINE) {
+            top = SDL_min(rect->y, rect->h);
+            rows = SDL_max(rect->y, rect->h) - top + 1.0f;
+        }
+        if (!rows_visible(renderer, top, rows)) {
+            continue;
+        }
+
+        SDL_SetRenderDrawColor(renderer, command->color.r, command->color.g, command->color.b, command->color.a);
+        switch (command->op) {
+            case DISPLAY_TEXT:
+                draw_text(list, renderer, command);
+                break;
+            case DISPLAY_RECT:
+                SDL_RenderFillRect(renderer, rect);
+                break;
+            case DISPLAY_FRAME:
+                SDL_RenderRect(renderer, rect);
+                break;
+            case DISPLAY_LINE:
+                SDL_RenderLine(renderer, rect->x, rect->y, rect->w, rect->h);
+                break;
+        }
+    }
+    TRACE_END("display_list");
+}
@@ -0,0 +1,55 @@
+#ifndef DISPLAY_LIST_H
+#define DISPLAY_LIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "SDL3/SDL.h"
+#include "SDL3_ttf/SDL_ttf.h"
+
+// Recorded drawing commands. Widgets record once per frame and every band or
+// layer replays the list, so their Lua code does not run once per band.
+#define DISPLAY_LIST_MAX_COMMANDS 128
+#define DISPLAY_LIST_TEXT_POOL    2048  // Bytes for the strings of all text commands
+
+typedef enum {
+    DISPLAY_TEXT,
+    DISPLAY_RECT,
+    DISPLAY_FRAME,
+    DISPLAY_LINE,
+} display_op_t;
+
+typedef struct {
+    display_op_t op;
+    SDL_Color color;
+    SDL_FRect rect;      // Lines: from (x, y) to (w, h)
+    uint16_t text;       // Offset into the text pool
+} display_command_t;
+
+typedef struct {
+    TTF_Font *font;
+    display_command_t commands[DISPLAY_LIST_MAX_COMMANDS];
+    int count;
+    char text[DISPLAY_LIST_TEXT_POOL];
+    size_t text_used;
+} display_list_t;
+
+// Position to roll back to when a recording fails halfway
+typedef struct {
+    int count;
+    size_t text_used;
+} display_list_mark_t;
+
+void display_list_init(display_list_t *list, TTF_Font *font);
+void display_list_clear(display_list_t *list);
+display_list_mark_t display_list_mark(const display_list_t *list);
+void display_list_rewind(display_list_t *list, display_list_mark_t mark);
+
+// Recording; false when the list is full
+bool display_list_text(display_list_t *list, float x, float y, const char *text, SDL_Color color, int *w, int *h);
+bool display_list_rect(display_list_t *list, display_op_t op, SDL_FRect rect, SDL_Color color);
+bool display_list_line(display_list_t *list, float x1, float y1, float x2, float y2, SDL_Color color);
+
+void display_list_draw(const display_list_t *list, SDL_Renderer *renderer);
+
+#endif // DISPLAY_LIST_H
@@ -4,6 +4,7 @@
 #include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <time.h>
 
 // ESP-IDF includes
@@ -13,9 +14,9 @@
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_netif.h"
-#include "esp_sntp.h"
+#include "esp_timer.h"
 #include "esp_http_client.h"
-#include "cJSON.h"
+#include "esp_random.h"
 
 // FreeRTOS includes
 #include "freertos/FreeRTOS.h"
@@ -29,26 +30,60 @@
 
 #include "bsp/esp-bsp.h"
 
-#include "esp_vfs.h"
-#include "esp_littlefs.h"
+#include "assetpack.h"
 
-#include "filesystem.h"
+#include "widgets.h"
+
+#include "ui.h"
+
+#include "touch.h"
+
+#include "trace.h"
+
+#include "console.h"
+
+#include "metrics.h"
+
+#include "anim.h"
+
+#include "history.h"
+
+#ifdef CONFIG_WEATHER_STRIP_RENDERER
+#include "strip.h"
+#endif
 
 #include "graphics.h"
 
 #include "weather.h"
 
+#include "weather_digest.h"
+
+#include "weather_json.h"
+
+#include "http_body.h"
+
+#include "scheduler.h"
+
+#include "timesync.h"
+
 static const char *TAG = "WeatherApp";
 
 char wifi_ssid[32];
 char wifi_password[64];
 
 #define MAXIMUM_RETRY   5
+#define WIFI_CONNECT_TIMEOUT_MS 30000
+// How long a fetch window stays open for SNTP after the HTTP request is done
+#define TIME_SYNC_GRACE_MS 3000
 
 // OpenWeatherMap API details
 char openweather_api_key[42];
 char openweather_city_name[32];
 char openweather_code[6];
+// Optional "host[:port]" override, e.g. a local stand-in server
+char openweather_host[64] = "api.openweathermap.org";
+// Optional "host[:port]" of a local digest gateway; empty fetches JSON from OpenWeatherMap
+char gateway_host[64] = "";
 
 // Event group to signal when we are connected
 static EventGroupHandle_t s_wifi_event_group;
@@ -56,17 +91,24 @@ static EventGroupHandle_t s_wifi_event_group;
 #define WIFI_FAIL_BIT      BIT1
 
 static int s_retry_num = 0;
+// Set while a fetch window wants the radio up; disconnects outside of it are expected
+static bool s_wifi_active = false;
 
 SDL_Window *window;
 SDL_Renderer *renderer;
 TTF_Font *font;
 
+#ifdef CONFIG_WEATHER_STRIP_RENDERER
+static strip_renderer_t strip;
+#endif
 
 // Function prototypes
 static void wifi_init_sta(void);
-static void time_sync(void);
-static void fetch_weather_data(void);
-static void parse_weather_data(const char *json);
+static esp_err_t wifi_connect(void);
+static void wifi_disconnect(void);
+static esp_err_t fetch_weather_data(bool *request_sent);
+static esp_err_t apply_weather_json(const char *json);
+static esp_err_t apply_weather_digest(const uint8_t *data, size_t len);
 static void initialize_sdl();
 
 
@@ -94,9 +136,15 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
         esp_wifi_connect();
         ESP_LOGI(TAG, "Connecting to Wi-Fi...");
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        if (!s_wifi_active) {
+            ESP_LOGI(TAG, "Wi-Fi disconnected.");
+            return;
+        }
+        // Retries are limited per fetch window; the scheduler backs off between windows
         if (s_retry_num < MAXIMUM_RETRY) {
             esp_wifi_connect();
             s_retry_num++;
+            metrics_count(METRIC_WIFI_RETRIES);
             ESP_LOGI(TAG, "Retrying to connect to the Wi-Fi network...");
         } else {
             xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
@@ -147,6 +195,18 @@ esp_err_t get_wifi_credentials(void){
     err = nvs_get_str(nvs_mem_handle, "ow_country", openweather_code, &openweather_code_len);
     ESP_ERROR_CHECK(err);
 
+    size_t openweather_host_len = sizeof(openweather_host);
+    err = nvs_get_str(nvs_mem_handle, "ow_host", openweather_host, &openweather_host_len);
+    if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+        ESP_ERROR_CHECK(err);
+    }
+
+    size_t gateway_host_len = sizeof(gateway_host);
+    err = nvs_get_str(nvs_mem_handle, "gateway", gateway_host, &gateway_host_len);
+    if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+        ESP_ERROR_CHECK(err);
+    }
+
     nvs_close(nvs_mem_handle);
     return ESP_OK;
 }
@@ -200,59 +260,53 @@ void wifi_init_sta(void)
     // Set the Wi-Fi configuration
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
 
+    ESP_LOGI(TAG, "wifi_init_sta finished.");
+}
+
+// Bring the radio up for one fetch window and wait for an IP address
+static esp_err_t wifi_connect(void)
+{
+    xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT | WIFI_FAIL_BIT);
+    s_retry_num = 0;
+    s_wifi_active = true;
+
     // Start Wi-Fi
     ESP_ERROR_CHECK(esp_wifi_start());
 
     // **Disable Wi-Fi power saving mode**
     ESP_ERROR_CHECK(esp_wifi_set_ps(WIFI_PS_NONE));
 
-    ESP_LOGI(TAG, "wifi_init_sta finished.");
-
     // Wait for connection
     EventBits_t bits = xEventGroupWaitBits(s_wifi_event_group,
                                            WIFI_CONNECTED_BIT | WIFI_FAIL_BIT,
                                            pdFALSE,
                                            pdFALSE,
-                                           portMAX_DELAY);
+                                           pdMS_TO_TICKS(WIFI_CONNECT_TIMEOUT_MS));
 
     // Check the event bits to determine the connection status
     if (bits & WIFI_CONNECTED_BIT) {
         ESP_LOGI(TAG, "Connected to AP SSID:%s password:***",
                  wifi_ssid);
+        return ESP_OK;
     } else if (bits & WIFI_FAIL_BIT) {
         ESP_LOGI(TAG, "Failed to connect to SSID:%s, password:***",
                  wifi_ssid);
-    } else {
-        ESP_LOGE(TAG, "UNEXPECTED EVENT");
-    }
-}
-static char *response_buffer = NULL;
-static int response_len = 0;
-// Synchronize time using SNTP
-static void time_sync(void) {
-    ESP_LOGE(TAG, "Time sync.");
-    esp_sntp_setoperatingmode(SNTP_OPMODE_POLL);
-    esp_sntp_setservername(0, "pool.ntp.org"); // Use default NTP server
-    esp_sntp_init();
-
-    // Wait for time to be set
-    time_t now = 0;
-    struct tm timeinfo = { 0 };
-    int retry = 0;
-    const int retry_count = 10;
-    while (timeinfo.tm_year < (2016 - 1900) && ++retry < retry_count) {
-        ESP_LOGI(TAG, "Waiting for system time to be set... (%d/%d)", retry, retry_count);
-        vTaskDelay(2000 / portTICK_PERIOD_MS);
-        time(&now);
-        localtime_r(&now, &timeinfo);
-    }
-    if (retry == retry_count) {
-        ESP_LOGE(TAG, "Failed to synchronize time.");
-    } else {
-        ESP_LOGI(TAG, "Time synchronized: %s", asctime(&timeinfo));
+        return ESP_FAIL;
     }
+    ESP_LOGE(TAG, "Timed out connecting to SSID:%s", wifi_ssid);
+    return ESP_ERR_TIMEOUT;
 }
 
+// Turn the radio off again at the end of a fetch window
+static void wifi_disconnect(void)
+{
+    s_wifi_active = false;
+    ESP_LOGI(TAG, "Shutdown WiFi");
+    esp_wifi_stop();
+}
+static http_body_t s_response;
+// Set once the request headers are on the wire; only then does a fetch count against the API budget
+static bool s_request_sent;
 const char openweather_pem[] = R"EOF(
 -----BEGIN CERTIFICATE-----
 MIIGRjCCBS6gAwIBAgIRAOkdF7biDWqRMeJTQD8Ux4AwDQYJKoZIhvcNAQELBQAw
@@ -389,19 +443,18 @@ smPi9WIsgtRqAEFQ8TmDn5XpNpaYbg==
 esp_err_t _http_event_handler(esp_http_client_event_t *evt)
 {
     switch(evt->event_id) {
+        case HTTP_EVENT_HEADERS_SENT:
+            s_request_sent = true;
+            break;
+        case HTTP_EVENT_ON_HEADER:
+            if (strcasecmp(evt->header_key, "Date") == 0) {
+                time_sync_from_http_date(evt->header_value);
+            }
+            break;
         case HTTP_EVENT_ON_DATA:
             ESP_LOGD(TAG, "HTTP_EVENT_ON_DATA, len=%d", evt->data_len);
-            if (!esp_http_client_is_chunked_response(evt->client)) {
-                // Reallocate response_buffer to fit new data
-                char *ptr = realloc(response_buffer, response_len + evt->data_len + 1);
-                if (ptr == NULL) {
-                    ESP_LOGE(TAG, "Failed to allocate memory for response buffer");
-                    return ESP_FAIL;
-                }
-                response_buffer = ptr;
-                memcpy(response_buffer + response_len, evt->data, evt->data_len);
-                response_len += evt->data_len;
-                response_buffer[response_len] = '\0'; // Null-terminate
+            if (http_body_append(&s_response, evt->data, evt->data_len) != ESP_OK) {
+                return ESP_FAIL;
             }
             break;
         default:
@@ -412,16 +465,22 @@ esp_err_t _http_event_handler(esp_http_client_event_t *evt)
 
 
 // Fetch weather data from OpenWeatherMap
-static void fetch_weather_data(void) {
+static esp_err_t fetch_weather_data(bool *request_sent) {
     char url[256];
+    bool use_gateway = gateway_host[0] != '\0';
     // snprintf(url, sizeof(url), "https://georgik.rocks/tmp/weather.json");
-    snprintf(url, sizeof(url),
-             "http://api.openweathermap.org/data/2.5/weather?q=%s,%s&appid=%s&units=metric",
-             openweather_city_name, openweather_code, openweather_api_key);
+    if (use_gateway) {
+        // Binary digest: the gateway talks to OpenWeatherMap and holds the API key
+        snprintf(url, sizeof(url), "http://%s/digest?q=%s,%s",
+                 gateway_host, openweather_city_name, openweather_code);
+    } else {
+        snprintf(url, sizeof(url),
+                 "http://%s/data/2.5/weather?q=%s,%s&appid=%s&units=metric",
+                 openweather_host, openweather_city_name, openweather_code, openweather_api_key);
+    }
 
-    // Initialize response buffer
-    response_buffer = NULL;
-    response_len = 0;
+    http_body_init(&s_response, HTTP_BODY_LIMIT);
+    s_request_sent = false;
 
     esp_http_client_config_t config = {
         .url = url,
@@ -433,98 +492,96 @@ static void fetch_weather_data(void) {
 
     esp_http_client_handle_t client = esp_http_client_init(&config);
 
+    int64_t start_us = esp_timer_get_time();
+    TRACE_BEGIN("http_perform");
     esp_err_t err = esp_http_client_perform(client);
+    TRACE_END("http_perform");
+    int64_t elapsed_ms = (esp_timer_get_time() - start_us) / 1000;
 
     if (err == ESP_OK) {
         int status_code = esp_http_client_get_status_code(client);
-        ESP_LOGI(TAG, "HTTP GET Status = %d", status_code);
-
-        if (status_code == 200) {
-            if (response_buffer != NULL) {
-                ESP_LOGI(TAG, "Received weather data: %s", response_buffer);
-                parse_weather_data(response_buffer);
-                free(response_buffer);
-                response_buffer = NULL;
-                response_len = 0;
+        metrics_observe(METRIC_FETCH, esp_timer_get_time() - start_us);
+        metrics_http_status(status_code);
+        ESP_LOGI(TAG, "HTTP GET Status = %d, %u bytes in %lld ms", status_code, (unsigned)s_response.len, elapsed_ms);
+
+        // Same decisions the host fetch harness checks
+        err = http_body_check(&s_response, status_code, esp_http_client_is_complete_data_received(client));
+        if (err == ESP_OK) {
+            int64_t parse_start_us = esp_timer_get_time();
+            TRACE_BEGIN("parse");
+            if (use_gateway) {
+                err = apply_weather_digest((const uint8_t *)s_response.data, s_response.len);
             } else {
-                ESP_LOGE(TAG, "Response buffer is NULL");
+                ESP_LOGI(TAG, "Received weather data: %s", s_response.data);
+                err = apply_weather_json(s_response.data);
+            }
+            TRACE_END("parse");
+            metrics_observe(METRIC_PARSE, esp_timer_get_time() - parse_start_us);
+            if (err != ESP_OK) {
+                metrics_count(METRIC_PARSE_FAILURES);
             }
-        } else {
-            ESP_LOGE(TAG, "HTTP GET request failed with status code: %d", status_code);
         }
     } else {
         ESP_LOGE(TAG, "HTTP GET request failed: %s", esp_err_to_name(err));
+        metrics_count(METRIC_HTTP_ERRORS);
     }
 
+    http_body_free(&s_response);
+    *request_sent = s_request_sent;
+
     esp_http_client_cleanup(client);
+    return err;
 }
 
-// Parse the JSON weather data
-static void parse_weather_data(const char *json) {
-    cJSON *root = cJSON_Parse(json);
-    if (root == NULL) {
-        ESP_LOGE(TAG, "Failed to parse JSON");
-        return;
-    }
+// Parse an OpenWeatherMap document and publish it as the current weather
+static esp_err_t apply_weather_json(const char *json) {
+    weather_info_t weather;
 
-    cJSON *weather_array = cJSON_GetObjectItem(root, "weather");
-    if (weather_array != NULL && cJSON_GetArraySize(weather_array) > 0) {
-        cJSON *weather = cJSON_GetArrayItem(weather_array, 0);
-        cJSON *description = cJSON_GetObjectItem(weather, "description");
-        cJSON *icon = cJSON_GetObjectItem(weather, "icon");
+    weather_lock();
+    weather = current_weather;
+    weather_unlock();
 
-        if (description != NULL && icon != NULL) {
-            strncpy(current_weather.description, description->valuestring, sizeof(current_weather.description));
-            strncpy(current_weather.icon, icon->valuestring, sizeof(current_weather.icon));
-        }
+    esp_err_t err = weather_parse_json(json, &weather);
+    if (err != ESP_OK) {
+        return err;
     }
 
-    cJSON *main = cJSON_GetObjectItem(root, "main");
-    if (main != NULL) {
-        cJSON *temp = cJSON_GetObjectItem(main, "temp");
-        cJSON *pressure = cJSON_GetObjectItem(main, "pressure");
-        cJSON *humidity = cJSON_GetObjectItem(main, "humidity");
+    weather_lock();
+    current_weather = weather;
+    weather_unlock();
 
-        if (temp != NULL) current_weather.temperature = temp->valuedouble;
-        if (pressure != NULL) current_weather.pressure = pressure->valueint;
-        if (humidity != NULL) current_weather.humidity = humidity->valueint;
-    }
+    ESP_LOGI(TAG, "Parsed weather data:");
+    ESP_LOGI(TAG, "Description: %s", weather.description);
+    ESP_LOGI(TAG, "Icon: %s", weather.icon);
+    ESP_LOGI(TAG, "Temperature: %.2f", weather.temperature);
+    ESP_LOGI(TAG, "Pressure: %d", weather.pressure);
+    ESP_LOGI(TAG, "Humidity: %d", weather.humidity);
+    ESP_LOGI(TAG, "Sunrise: %02d:%02d", weather.sunrise_hour, weather.sunrise_minute);
+    ESP_LOGI(TAG, "Sunset: %02d:%02d", weather.sunset_hour, weather.sunset_minute);
+    return ESP_OK;
+}
 
-    // Parse sunrise and sunset
-    cJSON *sys = cJSON_GetObjectItem(root, "sys");
-    if (sys != NULL) {
-        cJSON *sunrise = cJSON_GetObjectItem(sys, "sunrise");
-        cJSON *sunset = cJSON_GetObjectItem(sys, "sunset");
-
-        if (sunrise != NULL) {
-            current_weather.sunrise = (time_t)sunrise->valueint; // Store as time_t
-            struct tm *sunrise_tm = localtime(&current_weather.sunrise);
-            if (sunrise_tm != NULL) {
-                current_weather.sunrise_hour = sunrise_tm->tm_hour;
-                current_weather.sunrise_minute = sunrise_tm->tm_min;
-            }
-        }
 
-        if (sunset != NULL) {
-            current_weather.sunset = (time_t)sunset->valueint; // Store as time_t
-            struct tm *sunset_tm = localtime(&current_weather.sunset);
-            if (sunset_tm != NULL) {
-                current_weather.sunset_hour = sunset_tm->tm_hour;
-                current_weather.sunset_minute = sunset_tm->tm_min;
-            }
-        }
+// Validate a gateway digest and publish it as the current weather
+static esp_err_t apply_weather_digest(const uint8_t *data, size_t len) {
+    weather_info_t weather;
+
+    weather_lock();
+    weather = current_weather;
+    weather_unlock();
+
+    esp_err_t err = weather_digest_decode(data, len, &weather);
+    if (err != ESP_OK) {
+        return err;
     }
 
-    cJSON_Delete(root);
+    weather_lock();
+    current_weather = weather;
+    weather_unlock();
 
-    ESP_LOGI(TAG, "Parsed weather data:");
-    ESP_LOGI(TAG, "Description: %s", current_weather.description);
-    ESP_LOGI(TAG, "Icon: %s", current_weather.icon);
-    ESP_LOGI(TAG, "Temperature: %.2f", current_weather.temperature);
-    ESP_LOGI(TAG, "Pressure: %d", current_weather.pressure);
-    ESP_LOGI(TAG, "Humidity: %d", current_weather.humidity);
-    ESP_LOGI(TAG, "Sunrise: %02d:%02d", current_weather.sunrise_hour, current_weather.sunrise_minute);
-    ESP_LOGI(TAG, "Sunset: %02d:%02d", current_weather.sunset_hour, current_weather.sunset_minute);
+    ESP_LOGI(TAG, "Digest: %.2f°C, %d hPa, %d%%, %s", weather.temperature, weather.pressure,
+             weather.humidity, weather.description);
+    return ESP_OK;
 }
 
 
@@ -535,6 +592,13 @@ static void initialize_sdl() {
         return;
     }
 
+#ifdef CONFIG_WEATHER_STRIP_RENDERER
+    // Bands go straight to the panel, no window and no full framebuffer
+    if (strip_init(&strip, BSP_LCD_H_RES, BSP_LCD_V_RES, CONFIG_WEATHER_STRIP_BAND_ROWS) != ESP_OK) {
+        return;
+    }
+    renderer = strip.renderer;
+#else
      window = SDL_CreateWindow("SDL on ESP32", BSP_LCD_H_RES, BSP_LCD_V_RES, 0);
     if (!window) {
         printf("Failed to create window: %s\n", SDL_GetError());
@@ -547,19 +611,117 @@ static void initialize_sdl() {
         SDL_DestroyWindow(window);
         return;
     }
+#endif
 
     if (!TTF_Init()) {
         ESP_LOGE(TAG, "Failed to initialize TTF: %s", SDL_GetError());
         return;
     }
 
-    font = TTF_OpenFont("/assets/FreeSans.ttf", 24); // Ensure the font file is available
+    // Served straight from the mapped asset pack, no copy into RAM
+    SDL_IOStream *font_io = assetpack_open_io("FreeSans.ttf");
+    if (!font_io) {
+        ESP_LOGE(TAG, "Failed to open font asset: %s", SDL_GetError());
+        return;
+    }
+    font = TTF_OpenFontIO(font_io, true, 24);
     if (!font) {
         ESP_LOGE(TAG, "Failed to open font: %s", SDL_GetError());
         return;
     }
+
+    widgets_init(font, BSP_LCD_H_RES, BSP_LCD_V_RES, SDL_NS_PER_SECOND / PANEL_REFRESH_HZ);
+}
+
+#ifdef CONFIG_WEATHER_STRIP_RENDERER
+// Scene callback for the strip renderer, called once per band
+static void draw_page_band(SDL_Renderer *band_renderer, void *ctx) {
+    const ui_state_t *ui = ctx;
+    draw_weather_page(band_renderer, font, ui->page, ui->detail);
 }
+#endif
+
 
+// Longest single sleep, so a clock step after time sync is picked up quickly
+#define SCHEDULER_MAX_SLEEP_S 60
+
+// Plan fetch windows, keep the radio off between them and notify the renderer
+static void scheduler_task(void *arg) {
+    scheduler_config_t config = SCHEDULER_CONFIG_DEFAULT();
+    scheduler_t scheduler;
+
+    scheduler_init(&scheduler, &config, time(NULL), esp_random());
+
+    while (1) {
+        time_t now = time(NULL);
+        time_t next = scheduler_next_fetch(&scheduler);
+        if (next > now) {
+            time_t wait = next - now;
+            if (wait > SCHEDULER_MAX_SLEEP_S) {
+                wait = SCHEDULER_MAX_SLEEP_S;
+            }
+            vTaskDelay(pdMS_TO_TICKS(wait * 1000));
+            continue;
+        }
+
+        if (!scheduler_budget_available(&scheduler, now)) {
+            ESP_LOGW(TAG, "Daily API budget spent, next fetch at %lld", (long long)scheduler_next_fetch(&scheduler));
+            continue;
+        }
+
+        int64_t connect_start_us = esp_timer_get_time();
+        TRACE_BEGIN("wifi_connect");
+        esp_err_t err = wifi_connect();
+        TRACE_END("wifi_connect");
+        if (err == ESP_OK) {
+            metrics_observe(METRIC_WIFI_CONNECT, esp_timer_get_time() - connect_start_us);
+        } else {
+            metrics_count(METRIC_WIFI_FAILURES);
+        }
+        if (err == ESP_OK) {
+            // SNTP runs alongside the fetch; the Date header covers a slow NTP server
+            time_sync_start();
+            bool request_sent = false;
+            TRACE_BEGIN("fetch");
+            err = fetch_weather_data(&request_sent);
+            TRACE_END("fetch");
+            if (request_sent) {
+                scheduler_count_call(&scheduler, time(NULL));
+            }
+            if (err == ESP_OK) {
+                // Render right away; the SNTP grace period below only concerns the clock
+                ui_notify_weather_updated();
+            }
+            if (time_sync_wait(TIME_SYNC_GRACE_MS) != ESP_OK && !time_sync_is_valid()) {
+                ESP_LOGW(TAG, "Failed to synchronize time.");
+            }
+            time_sync_stop();
+        }
+        wifi_disconnect();
+        metrics_sample_heap();
+
+        now = time(NULL);
+        if (err == ESP_OK) {
+            weather_lock();
+            time_t data_dt = current_weather.dt;
+            history_sample_t sample = {
+                .time = current_weather.dt,
+                .temperature = current_weather.temperature,
+                .pressure = current_weather.pressure,
+                .humidity = current_weather.humidity,
+            };
+            weather_unlock();
+            if (history_append(&sample) != ESP_OK) {
+                ESP_LOGW(TAG, "Failed to log weather sample");
+            }
+            scheduler_on_success(&scheduler, now, data_dt, time_sync_is_valid());
+        } else {
+            scheduler_on_failure(&scheduler, now);
+        }
+        ESP_LOGI(TAG, "Next fetch in %lld s (API calls today: %d)",
+                 (long long)(scheduler_next_fetch(&scheduler) - now), scheduler.calls_today);
+    }
+}
 
 // Application
 void* sdl_thread(void* args) {
@@ -573,22 +735,38 @@ void* sdl_thread(void* args) {
     }
     ESP_ERROR_CHECK(ret);
 
+    metrics_init();
+
+    // Weather log; the display still works without it
+    history_init();
+
+    // Serial commands (trace, metrics and history dump)
+    console_init();
+
     // Initialize Wi-Fi
     ESP_LOGI(TAG, "ESP_WIFI_MODE_STA");
     wifi_init_sta();
 
-    SDL_InitFS();
+    // A missing or corrupt asset pack must not reboot-loop the device: run without fonts and widgets
+    ret = assetpack_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Asset pack unavailable (%s), continuing without assets", esp_err_to_name(ret));
+    }
     initialize_sdl();
 
-    // Synchronize time using SNTP
-    time_sync();
+    ui_state_t ui;
+    ui_init(&ui, BSP_LCD_H_RES, BSP_LCD_V_RES);
+    // Not fatal: the e-paper board has no touch controller
+    touch_init(ui.width, ui.height);
 
-    // Fetch weather data
-    fetch_weather_data();
+#ifndef CONFIG_WEATHER_STRIP_RENDERER
+    // Page transitions get at most one panel refresh interval of CPU per frame
+    anim_engine_t anim;
+    anim_init(&anim, renderer, font, ui.width, ui.height, SDL_NS_PER_SECOND / PANEL_REFRESH_HZ);
+#endif
 
-    ESP_LOGI(TAG, "Shutdown WiFi");
-    esp_wifi_stop();
-    esp_wifi_deinit();
+    // Fetches run in their own task; this thread owns SDL and only renders
+    xTaskCreate(scheduler_task, "scheduler", 8192, NULL, 5, NULL);
 
     // Clean up
     // if (font) TTF_CloseFont(font);
@@ -597,14 +775,70 @@ void* sdl_thread(void* args) {
     // if (window) SDL_DestroyWindow(window);
     // SDL_Quit();
 
-    // Render weather data
-    render_weather_data(renderer, font);
-    ESP_LOGI(TAG, "Finished rendering. ");
+    // Widget output for the first layers, before any weather arrived
+    weather_lock();
+    widgets_update();
+    weather_unlock();
 
-    // Optionally, enter deep sleep or restart
+    // Boot to the first frame showing fetched weather; earlier frames are empty pages
+    bool first_weather_render = true;
+
+    ESP_LOGI(TAG, "Entering main loop...");
     while(1) {
+        // Sleep until an event arrives or the next paced frame is due
+        SDL_Event event;
+        if (SDL_WaitEventTimeout(&event, ui_frame_timeout_ms(&ui, SDL_GetTicksNS()))) {
+            do {
+                ui_handle_event(&ui, &event);
+            } while (SDL_PollEvent(&event));
+        }
+
+        if (ui_frame_timeout_ms(&ui, SDL_GetTicksNS()) != 0) {
+            continue;
+        }
+
+        // Render weather data
+        int64_t render_start_us = esp_timer_get_time();
+        weather_lock();
+#ifdef CONFIG_WEATHER_STRIP_RENDERER
+        // Widgets run once per frame; every band replays what they recorded
+        widgets_update();
+        strip_render(&strip, draw_page_band, &ui);
+#else
+        Uint64 now = SDL_GetTicksNS();
+        if (ui.weather_updated) {
+            // Layers are only rasterized again after an update, so widgets run then too
+            widgets_update();
+            anim_invalidate(&anim);
+        }
+        anim_show(&anim, ui.page, ui.detail, ui.direction, now);
+        anim_frame(&anim, now);
+#endif
+        weather_unlock();
+        ui_frame_presented(&ui, SDL_GetTicksNS());
+        metrics_observe(METRIC_RENDER, esp_timer_get_time() - render_start_us);
+
+#ifndef CONFIG_WEATHER_STRIP_RENDERER
+        // Keep frames coming until the transition settles
+        if (anim_active(&anim)) {
+            ui.dirty = true;
+        }
+#endif
 
-        vTaskDelay(10000 / portTICK_PERIOD_MS);
+        if (ui.weather_updated) {
+            ui.weather_updated = false;
+            if (first_weather_render) {
+                ESP_LOGI(TAG, "Time to first render: %lld ms", esp_timer_get_time() / 1000);
+                first_weather_render = false;
+            }
+            metrics_sample_heap();
+            ESP_LOGI(TAG, "Finished rendering. ");
+            widgets_log_stats();
+            ui_log_latency(&ui);
+#ifdef CONFIG_WEATHER_STRIP_RENDERER
+            strip_log_stats(&strip);
+#endif
+        }
     }
     // esp_restart();
 }
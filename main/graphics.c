@@ -1,7 +1,10 @@
 #include "graphics.h"
 #include <stdio.h>
+#include <time.h>
 #include "esp_log.h"
 #include "weather.h"
+#include "widgets.h"
+#include "trace.h"
 
 // SDL_Color textColor = {255, 255, 255, 255}; // White color
 SDL_Color textColor = {0, 0, 0, 255}; // Black color
@@ -38,95 +41,67 @@ void draw_image(SDL_Renderer *renderer, SDL_Texture *texture, float x, float y,
     SDL_RenderTexture(renderer, texture, NULL, &destRect);
 }
 
-void draw_moving_rectangles(SDL_Renderer *renderer, float rect_x) {
-    DrawColoredRect(renderer, rect_x, 20, 50, 10, 0, 0, 0, 0);
-    DrawColoredRect(renderer, rect_x, 20, 50, 10, 255, 0, 0, 1);
-    DrawColoredRect(renderer, rect_x, 20, 50, 10, 255, 165, 0, 2);
-    DrawColoredRect(renderer, rect_x, 20, 50, 10, 255, 255, 0, 3);
-    DrawColoredRect(renderer, rect_x, 20, 50, 10, 0, 255, 0, 4);
-    DrawColoredRect(renderer, rect_x, 20, 50, 10, 0, 0, 255, 5);
-    DrawColoredRect(renderer, rect_x, 20, 50, 10, 75, 0, 130, 6);
-    DrawColoredRect(renderer, rect_x, 20, 50, 10, 238, 130, 238, 7);
-    DrawColoredRect(renderer, rect_x, 20, 50, 10, 255, 255, 255, 8);
+// False when rows y..y+h fall outside the area being drawn, e.g. another band of the strip renderer
+bool rows_visible(SDL_Renderer *renderer, float y, float h) {
+    SDL_Rect viewport;
+    int output_w = 0, output_h = 0;
+    SDL_GetRenderViewport(renderer, &viewport);
+    SDL_GetCurrentRenderOutputSize(renderer, &output_w, &output_h);
+    float top = (float)-viewport.y;
+    return y + h > top && y < top + output_h;
 }
 
-void DrawColoredRect(SDL_Renderer *renderer, int x, int y, int w, int h, Uint8 r, Uint8 g, Uint8 b, int index) {
-    SDL_SetRenderDrawColor(renderer, r, g, b, 255);
-    SDL_FRect rect = {x, y + index * h, w, h};
-    SDL_RenderFillRect(renderer, &rect);
+// Render one line of text at the given position
+static void draw_text_line(SDL_Renderer *renderer, TTF_Font *font, const char *text, float x, float y) {
+    // No font without the asset pack; skip quietly instead of logging every line of every frame
+    if (font == NULL || !rows_visible(renderer, y, (float)TTF_GetFontHeight(font))) {
+        return;
+    }
+    TRACE_BEGIN("rasterize");
+    SDL_Surface *surface = TTF_RenderText_Blended(font, text, 0, textColor);
+    TRACE_END("rasterize");
+    if (!surface) {
+        ESP_LOGE(TAG, "Failed to render text: %s", SDL_GetError());
+        return;
+    }
+    TRACE_BEGIN("create_texture");
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+    TRACE_END("create_texture");
+    SDL_FRect rect = {x, y, (float)surface->w, (float)surface->h};
+    TRACE_BEGIN("render_texture");
+    SDL_RenderTexture(renderer, texture, NULL, &rect);
+    TRACE_END("render_texture");
+    SDL_DestroySurface(surface);
+    SDL_DestroyTexture(texture);
 }
 
+// Current conditions, the original single-screen layout
+static void draw_current_page(SDL_Renderer *renderer, TTF_Font *font, bool detail) {
+    char line[64];
 
-// Render weather data using SDL
-void render_weather_data(SDL_Renderer *renderer, TTF_Font *font) {
-    ESP_LOGI(TAG, "Clearing screen. ");
-    // Clear screen
-    clear_screen(renderer);
+    snprintf(line, sizeof(line), "Temperature: %.1f°C", current_weather.temperature);
+    draw_text_line(renderer, font, line, 20.0f, 20.0f);
+
+    snprintf(line, sizeof(line), "Pressure: %d hPa", current_weather.pressure);
+    draw_text_line(renderer, font, line, 20.0f, 60.0f);
+
+    snprintf(line, sizeof(line), "Humidity: %d%%", current_weather.humidity);
+    draw_text_line(renderer, font, line, 20.0f, 100.0f);
 
-    ESP_LOGI(TAG, "Preparing content. ");
-    // Prepare text strings
-    char temp_str[64];
-    snprintf(temp_str, sizeof(temp_str), "Temperature: %.1f°C", current_weather.temperature);
-
-    char pressure_str[64];
-    snprintf(pressure_str, sizeof(pressure_str), "Pressure: %d hPa", current_weather.pressure);
-
-    char humidity_str[64];
-    snprintf(humidity_str, sizeof(humidity_str), "Humidity: %d%%", current_weather.humidity);
-
-    ESP_LOGI(TAG, "Sending SDL data ");
-    // Render temperature
-    SDL_Surface *temp_surface = TTF_RenderText_Blended(font, temp_str, 0, textColor);
-    SDL_Texture *temp_texture = SDL_CreateTextureFromSurface(renderer, temp_surface);
-    SDL_FRect temp_rect = {20.0f, 20.0f, (float)temp_surface->w, (float)temp_surface->h};
-    SDL_RenderTexture(renderer, temp_texture, NULL, &temp_rect);
-    SDL_DestroySurface(temp_surface);
-    SDL_DestroyTexture(temp_texture);
-
-    // Render pressure
-    SDL_Surface *pressure_surface = TTF_RenderText_Blended(font, pressure_str, 0, textColor);
-    SDL_Texture *pressure_texture = SDL_CreateTextureFromSurface(renderer, pressure_surface);
-    SDL_FRect pressure_rect = {20.0f, 60.0f, (float)pressure_surface->w, (float)pressure_surface->h};
-    SDL_RenderTexture(renderer, pressure_texture, NULL, &pressure_rect);
-    SDL_DestroySurface(pressure_surface);
-    SDL_DestroyTexture(pressure_texture);
-
-    // Render humidity
-    SDL_Surface *humidity_surface = TTF_RenderText_Blended(font, humidity_str, 0, textColor);
-    SDL_Texture *humidity_texture = SDL_CreateTextureFromSurface(renderer, humidity_surface);
-    SDL_FRect humidity_rect = {20.0f, 100.0f, (float)humidity_surface->w, (float)humidity_surface->h};
-    SDL_RenderTexture(renderer, humidity_texture, NULL, &humidity_rect);
-    SDL_DestroySurface(humidity_surface);
-    SDL_DestroyTexture(humidity_texture);
-
-    // Render description
-    SDL_Surface *desc_surface = TTF_RenderText_Blended(font, current_weather.description, 0, textColor);
-    SDL_Texture *desc_texture = SDL_CreateTextureFromSurface(renderer, desc_surface);
-    SDL_FRect desc_rect = {20.0f, 140.0f, (float)desc_surface->w, (float)desc_surface->h};
-    SDL_RenderTexture(renderer, desc_texture, NULL, &desc_rect);
-    SDL_DestroySurface(desc_surface);
-    SDL_DestroyTexture(desc_texture);
-
-        // Render sunrise time
-    char sunrise_str[64];
-    snprintf(sunrise_str, sizeof(sunrise_str), "Sunrise: %02d:%02d", current_weather.sunrise_hour, current_weather.sunrise_minute);
-    SDL_Surface *sunrise_surface = TTF_RenderText_Blended(font, sunrise_str, 0, textColor);
-    SDL_Texture *sunrise_texture = SDL_CreateTextureFromSurface(renderer, sunrise_surface);
-    SDL_FRect sunrise_rect = {20.0f, 180.0f, (float)sunrise_surface->w, (float)sunrise_surface->h};
-    SDL_RenderTexture(renderer, sunrise_texture, NULL, &sunrise_rect);
-    SDL_DestroySurface(sunrise_surface);
-    SDL_DestroyTexture(sunrise_texture);
-
-    // Render sunset time
-    char sunset_str[64];
-    snprintf(sunset_str, sizeof(sunset_str), "Sunset: %02d:%02d", current_weather.sunset_hour, current_weather.sunset_minute);
-    SDL_Surface *sunset_surface = TTF_RenderText_Blended(font, sunset_str, 0, textColor);
-    SDL_Texture *sunset_texture = SDL_CreateTextureFromSurface(renderer, sunset_surface);
-    SDL_FRect sunset_rect = {20.0f, 220.0f, (float)sunset_surface->w, (float)sunset_surface->h};
-    SDL_RenderTexture(renderer, sunset_texture, NULL, &sunset_rect);
-    SDL_DestroySurface(sunset_surface);
-    SDL_DestroyTexture(sunset_texture);
+    draw_text_line(renderer, font, current_weather.description, 20.0f, 140.0f);
 
+    snprintf(line, sizeof(line), "Sunrise: %02d:%02d", current_weather.sunrise_hour, current_weather.sunrise_minute);
+    draw_text_line(renderer, font, line, 20.0f, 180.0f);
+
+    snprintf(line, sizeof(line), "Sunset: %02d:%02d", current_weather.sunset_hour, current_weather.sunset_minute);
+    draw_text_line(renderer, font, line, 20.0f, 220.0f);
+
+    if (detail) {
+        struct tm observed;
+        localtime_r(&current_weather.dt, &observed);
+        snprintf(line, sizeof(line), "Updated: %02d:%02d  Icon: %s", observed.tm_hour, observed.tm_min, current_weather.icon);
+        draw_text_line(renderer, font, line, 20.0f, 260.0f);
+    }
 
     // Load and render weather icon
     // char icon_path[64];
@@ -141,9 +116,54 @@ void render_weather_data(SDL_Renderer *renderer, TTF_Font *font) {
     // } else {
     //     ESP_LOGE(TAG, "Failed to load icon: %s", SDL_GetError());
     // }
+}
+
+// Sun page: sunrise, sunset and length of the day
+static void draw_sun_page(SDL_Renderer *renderer, TTF_Font *font, bool detail) {
+    char line[64];
+    long day_length = (long)(current_weather.sunset - current_weather.sunrise);
+    if (day_length < 0) {
+        day_length = 0;
+    }
+
+    snprintf(line, sizeof(line), "Sunrise: %02d:%02d", current_weather.sunrise_hour, current_weather.sunrise_minute);
+    draw_text_line(renderer, font, line, 20.0f, 20.0f);
+
+    snprintf(line, sizeof(line), "Sunset: %02d:%02d", current_weather.sunset_hour, current_weather.sunset_minute);
+    draw_text_line(renderer, font, line, 20.0f, 60.0f);
+
+    snprintf(line, sizeof(line), "Day length: %ld:%02ld", day_length / 3600, (day_length / 60) % 60);
+    draw_text_line(renderer, font, line, 20.0f, 100.0f);
+
+    if (detail) {
+        time_t now = time(NULL);
+        long remaining = (long)(current_weather.sunset - now);
+        if (remaining > 0 && now >= current_weather.sunrise) {
+            snprintf(line, sizeof(line), "Daylight left: %ld:%02ld", remaining / 3600, (remaining / 60) % 60);
+        } else {
+            snprintf(line, sizeof(line), "Night");
+        }
+        draw_text_line(renderer, font, line, 20.0f, 140.0f);
+    }
+}
 
-    // Update the renderer to display everything
-    ESP_LOGI(TAG, "Flushing to screen. ");
-    SDL_RenderPresent(renderer);
-    ESP_LOGI(TAG, "Draw operation complete ");
+// Draw one page without presenting it
+void draw_weather_page(SDL_Renderer *renderer, TTF_Font *font, int page, bool detail) {
+    TRACE_BEGIN("draw_page");
+    clear_screen(renderer);
+
+    switch (page) {
+        case WEATHER_PAGE_SUN:
+            draw_sun_page(renderer, font, detail);
+            break;
+        case WEATHER_PAGE_CURRENT:
+        default:
+            draw_current_page(renderer, font, detail);
+            // Scripted widgets on top of the built-in layout, replayed from their last update
+            TRACE_BEGIN("widgets");
+            widgets_draw(renderer);
+            TRACE_END("widgets");
+            break;
+    }
+    TRACE_END("draw_page");
 }
@@ -4,11 +4,16 @@
 #include "SDL3/SDL.h"
 #include "SDL3_ttf/SDL_ttf.h"
 
+typedef enum {
+    WEATHER_PAGE_CURRENT,
+    WEATHER_PAGE_SUN,
+    WEATHER_PAGE_COUNT,
+} weather_page_t;
+
 void clear_screen(SDL_Renderer *renderer);
+bool rows_visible(SDL_Renderer *renderer, float y, float h);
 void draw_image(SDL_Renderer *renderer, SDL_Texture *texture, float x, float y, float w, float h);
-void draw_moving_rectangles(SDL_Renderer *renderer, float rect_x);
-void DrawColoredRect(SDL_Renderer *renderer, int x, int y, int w, int h, Uint8 r, Uint8 g, Uint8 b, int index);
 SDL_Texture *LoadBackgroundImage(SDL_Renderer *renderer, const char *imagePath);
-void render_weather_data(SDL_Renderer *renderer, TTF_Font *font);
+void draw_weather_page(SDL_Renderer *renderer, TTF_Font *font, int page, bool detail);
 
 #endif // GRAPHICS_H
@@ -0,0 +1,459 @@
+#include "history.h"
+#include <dirent.h>
+#include <inttypes.h>
+#include <math.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "esp_littlefs.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+
+static const char *TAG = "history";
+
+#define QUERY_CHUNK 16  // Records read and decoded per step while streaming a range
+
+typedef struct {
+    history_segment_header_t header;
+    uint32_t count;
+    time_t last_time;  // base_time - 1 while the segment is empty
+} segment_info_t;
+
+// Index of segments on flash, oldest first; times increase across segments
+static segment_info_t s_segments[HISTORY_MAX_SEGMENTS];
+static int s_segment_count = 0;
+static bool s_ready = false;
+static pthread_mutex_t s_history_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void segment_path(uint32_t sequence, char *path, size_t size) {
+    snprintf(path, size, HISTORY_BASE_PATH "/seg_%08" PRIu32 ".bin", sequence);
+}
+
+static uint32_t header_crc(const history_segment_header_t *header) {
+    return esp_rom_crc32_le(0, (const uint8_t *)header, offsetof(history_segment_header_t, crc));
+}
+
+static uint16_t record_crc(const history_record_t *record) {
+    return esp_rom_crc16_le(0, (const uint8_t *)record, offsetof(history_record_t, crc));
+}
+
+static time_t record_time(const segment_info_t *segment, const history_record_t *record) {
+    return (time_t)(segment->header.base_time + record->time_offset);
+}
+
+static void decode_record(const segment_info_t *segment, const history_record_t *record, history_sample_t *sample) {
+    const history_segment_header_t *header = &segment->header;
+    sample->time = record_time(segment, record);
+    sample->temperature = (header->base_temperature + record->temperature_delta) / 100.0f;
+    sample->pressure = header->base_pressure + record->pressure_delta;
+    sample->humidity = header->base_humidity + record->humidity_delta;
+}
+
+static int16_t temperature_centi(float temperature) {
+    long centi = lroundf(temperature * 100.0f);
+    return (int16_t)(centi < INT16_MIN ? INT16_MIN : centi > INT16_MAX ? INT16_MAX : centi);
+}
+
+// False when the sample cannot be expressed relative to this segment's base
+static bool encode_record(const segment_info_t *segment, const history_sample_t *sample, history_record_t *record) {
+    const history_segment_header_t *header = &segment->header;
+    int64_t time_offset = (int64_t)sample->time - header->base_time;
+    int temperature_delta = temperature_centi(sample->temperature) - header->base_temperature;
+    int pressure_delta = sample->pressure - header->base_pressure;
+    int humidity_delta = sample->humidity - header->base_humidity;
+
+    if (time_offset < 0 || time_offset > UINT32_MAX ||
+        temperature_delta < INT16_MIN || temperature_delta > INT16_MAX ||
+        pressure_delta < INT16_MIN || pressure_delta > INT16_MAX ||
+        humidity_delta < INT8_MIN || humidity_delta > INT8_MAX) {
+        return false;
+    }
+
+    memset(record, 0, sizeof(*record));
+    record->time_offset = (uint32_t)time_offset;
+    record->temperature_delta = (int16_t)temperature_delta;
+    record->pressure_delta = (int16_t)pressure_delta;
+    record->humidity_delta = (int8_t)humidity_delta;
+    record->crc = record_crc(record);
+    return true;
+}
+
+// Validate a segment and cut it back to the last intact record. A power loss
+// during an append leaves at most one short or corrupt record at the end.
+static esp_err_t load_segment(uint32_t sequence, segment_info_t *segment) {
+    char path[64];
+    segment_path(sequence, path, sizeof(path));
+
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    history_segment_header_t *header = &segment->header;
+    if (fread(header, sizeof(*header), 1, f) != 1 ||
+        memcmp(header->magic, HISTORY_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != HISTORY_VERSION ||
+        header->record_size != sizeof(history_record_t) ||
+        header->sequence != sequence ||
+        header->crc != header_crc(header)) {
+        fclose(f);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    segment->count = 0;
+    segment->last_time = (time_t)header->base_time - 1;
+
+    history_record_t record;
+    while (fread(&record, sizeof(record), 1, f) == 1) {
+        if (record.crc != record_crc(&record) || record_time(segment, &record) <= segment->last_time) {
+            break;
+        }
+        segment->last_time = record_time(segment, &record);
+        segment->count++;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+
+    long valid = (long)(sizeof(*header) + segment->count * sizeof(history_record_t));
+    if (size > valid) {
+        ESP_LOGW(TAG, "Segment %" PRIu32 ": dropping %ld bytes of torn write after %" PRIu32 " records",
+                 sequence, size - valid, segment->count);
+        if (truncate(path, valid) != 0) {
+            ESP_LOGE(TAG, "Failed to truncate %s", path);
+            return ESP_FAIL;
+        }
+    }
+    return ESP_OK;
+}
+
+static int compare_sequence(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void delete_segment(uint32_t sequence) {
+    char path[64];
+    segment_path(sequence, path, sizeof(path));
+    if (unlink(path) != 0) {
+        ESP_LOGW(TAG, "Failed to delete %s", path);
+    }
+}
+
+// Drop the oldest segment from flash and from the index
+static void delete_oldest(void) {
+    delete_segment(s_segments[0].header.sequence);
+    memmove(&s_segments[0], &s_segments[1], (s_segment_count - 1) * sizeof(s_segments[0]));
+    s_segment_count--;
+}
+
+// Mount the partition and rebuild the segment index, repairing torn writes
+esp_err_t history_init(void) {
+    esp_vfs_littlefs_conf_t conf = {
+        .base_path = HISTORY_BASE_PATH,
+        .partition_label = "history",
+        .format_if_mount_failed = true,
+        .dont_mount = false,
+    };
+    esp_err_t err = esp_vfs_littlefs_register(&conf);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to mount history partition: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    DIR *dir = opendir(HISTORY_BASE_PATH);
+    if (dir == NULL) {
+        return ESP_FAIL;
+    }
+    uint32_t *sequences = NULL;
+    int found = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        uint32_t sequence;
+        char suffix[8];
+        if (sscanf(entry->d_name, "seg_%8" SCNu32 ".%7s", &sequence, suffix) != 2 || strcmp(suffix, "bin") != 0) {
+            continue;
+        }
+        uint32_t *grown = realloc(sequences, (found + 1) * sizeof(*sequences));
+        if (grown == NULL) {
+            break;
+        }
+        sequences = grown;
+        sequences[found++] = sequence;
+    }
+    closedir(dir);
+    if (found > 1) {
+        qsort(sequences, found, sizeof(*sequences), compare_sequence);
+    }
+
+    pthread_mutex_lock(&s_history_lock);
+    s_segment_count = 0;
+    for (int i = 0; i < found; i++) {
+        segment_info_t segment;
+        esp_err_t load_err = load_segment(sequences[i], &segment);
+        if (load_err == ESP_ERR_INVALID_STATE) {
+            // Header never made it to flash: the segment was being created
+            ESP_LOGW(TAG, "Segment %" PRIu32 " has no valid header, deleting", sequences[i]);
+            delete_segment(sequences[i]);
+            continue;
+        }
+        if (load_err != ESP_OK) {
+            continue;
+        }
+        if (s_segment_count > 0 && segment.header.base_time <= s_segments[s_segment_count - 1].last_time) {
+            ESP_LOGW(TAG, "Segment %" PRIu32 " overlaps its predecessor, deleting", sequences[i]);
+            delete_segment(sequences[i]);
+            continue;
+        }
+        if (s_segment_count == HISTORY_MAX_SEGMENTS) {
+            delete_oldest();
+        }
+        s_segments[s_segment_count++] = segment;
+    }
+    s_ready = true;
+    pthread_mutex_unlock(&s_history_lock);
+    free(sequences);
+
+    ESP_LOGI(TAG, "%d segments, %u samples", s_segment_count, (unsigned)history_count());
+    return ESP_OK;
+}
+
+// Start a segment whose base values are taken from its first sample
+static esp_err_t create_segment(const history_sample_t *sample) {
+    uint32_t sequence = s_segment_count > 0 ? s_segments[s_segment_count - 1].header.sequence + 1 : 0;
+    segment_info_t segment = {0};
+    history_segment_header_t *header = &segment.header;
+    memcpy(header->magic, HISTORY_MAGIC, sizeof(header->magic));
+    header->version = HISTORY_VERSION;
+    header->record_size = sizeof(history_record_t);
+    header->base_time = sample->time;
+    header->sequence = sequence;
+    header->base_temperature = temperature_centi(sample->temperature);
+    header->base_pressure = (uint16_t)sample->pressure;
+    header->base_humidity = (uint8_t)sample->humidity;
+    header->crc = header_crc(header);
+    segment.count = 0;
+    segment.last_time = (time_t)header->base_time - 1;
+
+    char path[64];
+    segment_path(sequence, path, sizeof(path));
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Failed to create %s", path);
+        return ESP_FAIL;
+    }
+    bool written = fwrite(header, sizeof(*header), 1, f) == 1 && fflush(f) == 0 && fsync(fileno(f)) == 0;
+    fclose(f);
+    if (!written) {
+        unlink(path);
+        return ESP_FAIL;
+    }
+
+    if (s_segment_count == HISTORY_MAX_SEGMENTS) {
+        delete_oldest();
+    }
+    s_segments[s_segment_count++] = segment;
+    return ESP_OK;
+}
+
+// Append one sample. Samples not newer than the last one logged are skipped,
+// so refetching the same observation is harmless.
+esp_err_t history_append(const history_sample_t *sample) {
+    pthread_mutex_lock(&s_history_lock);
+    if (!s_ready) {
+        pthread_mutex_unlock(&s_history_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (s_segment_count > 0 && sample->time <= s_segments[s_segment_count - 1].last_time) {
+        pthread_mutex_unlock(&s_history_lock);
+        ESP_LOGD(TAG, "Sample at %lld already logged", (long long)sample->time);
+        return ESP_OK;
+    }
+
+    history_record_t record;
+    segment_info_t *segment = s_segment_count > 0 ? &s_segments[s_segment_count - 1] : NULL;
+    if (segment == NULL || segment->count >= HISTORY_SEGMENT_RECORDS || !encode_record(segment, sample, &record)) {
+        esp_err_t err = create_segment(sample);
+        if (err != ESP_OK) {
+            pthread_mutex_unlock(&s_history_lock);
+            return err;
+        }
+        segment = &s_segments[s_segment_count - 1];
+        encode_record(segment, sample, &record);
+    }
+
+    // Written at the offset the index expects rather than appended, so bytes
+    // of an earlier failed write can never end up in front of this record
+    char path[64];
+    segment_path(segment->header.sequence, path, sizeof(path));
+    long offset = (long)(sizeof(history_segment_header_t) + segment->count * sizeof(record));
+    FILE *f = fopen(path, "r+b");
+    if (f == NULL) {
+        pthread_mutex_unlock(&s_history_lock);
+        ESP_LOGE(TAG, "Failed to open %s", path);
+        return ESP_FAIL;
+    }
+    // Synced before the index moves on, so the index never gets ahead of flash
+    bool written = fseek(f, offset, SEEK_SET) == 0 && fwrite(&record, sizeof(record), 1, f) == 1 &&
+                   fflush(f) == 0 && fsync(fileno(f)) == 0;
+    fclose(f);
+    if (written) {
+        segment->count++;
+        segment->last_time = sample->time;
+    } else if (truncate(path, offset) != 0) {
+        // Left in place, the partial record is overwritten by the next append
+        // or cut off at the next boot
+        ESP_LOGW(TAG, "Failed to cut %s back after a failed write", path);
+    }
+    pthread_mutex_unlock(&s_history_lock);
+
+    if (!written) {
+        ESP_LOGE(TAG, "Failed to append to %s", path);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+// First record index in the segment with time >= from, by bisection over fixed offsets
+static uint32_t find_record(FILE *f, const segment_info_t *segment, time_t from) {
+    uint32_t low = 0;
+    uint32_t high = segment->count;
+    history_record_t record;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        fseek(f, (long)(sizeof(history_segment_header_t) + mid * sizeof(record)), SEEK_SET);
+        if (fread(&record, sizeof(record), 1, f) != 1) {
+            return segment->count;
+        }
+        if (record_time(segment, &record) < from) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Where a range query stands between chunks. Segments are found again by
+// sequence number, as the index may change while the lock is released.
+typedef struct {
+    bool started;
+    bool done;
+    uint32_t sequence;
+    uint32_t index;     // Next record in that segment
+} query_cursor_t;
+
+// Decode the next chunk of the range. Called with s_history_lock held.
+static esp_err_t read_chunk(query_cursor_t *cursor, time_t from, time_t to, history_sample_t *samples, int *count) {
+    *count = 0;
+    int i = 0;
+    bool seek = false;
+    if (!cursor->started) {
+        // First segment that reaches into the range
+        int high = s_segment_count;
+        while (i < high) {
+            int mid = i + (high - i) / 2;
+            if (s_segments[mid].last_time < from) {
+                i = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        cursor->started = true;
+        seek = true;
+    } else {
+        while (i < s_segment_count && s_segments[i].header.sequence < cursor->sequence) {
+            i++;
+        }
+        if (i < s_segment_count && s_segments[i].header.sequence != cursor->sequence) {
+            // The segment was deleted meanwhile: go on with the next one
+            cursor->index = 0;
+        }
+    }
+
+    for (; i < s_segment_count; i++, cursor->index = 0, seek = false) {
+        const segment_info_t *segment = &s_segments[i];
+        if (segment->header.base_time > to) {
+            break;
+        }
+        if (segment->count == 0 || (!seek && cursor->index >= segment->count)) {
+            continue;
+        }
+
+        char path[64];
+        segment_path(segment->header.sequence, path, sizeof(path));
+        FILE *f = fopen(path, "rb");
+        if (f == NULL) {
+            return ESP_FAIL;
+        }
+        if (seek) {
+            cursor->index = find_record(f, segment, from);
+        }
+        if (cursor->index >= segment->count) {
+            fclose(f);
+            continue;
+        }
+
+        history_record_t chunk[QUERY_CHUNK];
+        uint32_t want = segment->count - cursor->index < QUERY_CHUNK ? segment->count - cursor->index : QUERY_CHUNK;
+        fseek(f, (long)(sizeof(history_segment_header_t) + cursor->index * sizeof(history_record_t)), SEEK_SET);
+        size_t got = fread(chunk, sizeof(chunk[0]), want, f);
+        fclose(f);
+        if (got == 0) {
+            return ESP_FAIL;
+        }
+        for (size_t j = 0; j < got; j++) {
+            decode_record(segment, &chunk[j], &samples[*count]);
+            if (samples[*count].time > to) {
+                cursor->done = true;
+                break;
+            }
+            (*count)++;
+        }
+        cursor->sequence = segment->header.sequence;
+        cursor->index += got;
+        return ESP_OK;
+    }
+    cursor->done = true;
+    return ESP_OK;
+}
+
+// Stream all samples with from <= time <= to, oldest first. Only a small
+// chunk of samples is held in RAM at a time, and the lock is released while
+// the visitor runs, so a slow one (printing to the console) does not hold up
+// appends.
+esp_err_t history_query(time_t from, time_t to, history_visit_fn visit, void *ctx) {
+    query_cursor_t cursor = {0};
+    history_sample_t samples[QUERY_CHUNK];
+    while (!cursor.done) {
+        int count = 0;
+        pthread_mutex_lock(&s_history_lock);
+        esp_err_t err = s_ready ? read_chunk(&cursor, from, to, samples, &count) : ESP_ERR_INVALID_STATE;
+        pthread_mutex_unlock(&s_history_lock);
+        if (err != ESP_OK) {
+            return err;
+        }
+        for (int i = 0; i < count; i++) {
+            if (!visit(&samples[i], ctx)) {
+                return ESP_OK;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+size_t history_count(void) {
+    size_t count = 0;
+    pthread_mutex_lock(&s_history_lock);
+    for (int i = 0; i < s_segment_count; i++) {
+        count += s_segments[i].count;
+    }
+    pthread_mutex_unlock(&s_history_lock);
+    return count;
+}
@@ -0,0 +1,60 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include "esp_err.h"
+
+// Append-only weather log on the "history" LittleFS partition. Samples go
+// into segment files of fixed-size records, delta-encoded against values in
+// the segment header. All fields little-endian.
+#ifndef HISTORY_BASE_PATH
+#define HISTORY_BASE_PATH        "/history"  // Host tests point this at a scratch directory
+#endif
+#define HISTORY_MAGIC            "WHST"
+#define HISTORY_VERSION          1
+#define HISTORY_SEGMENT_RECORDS  1008  // One week at 10 minute intervals
+#define HISTORY_MAX_SEGMENTS     16    // Oldest segment is deleted beyond this
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t record_size;
+    int64_t base_time;        // Time of the first sample
+    uint32_t sequence;        // Increases by one per segment, also in the file name
+    int16_t base_temperature; // Centi-degrees Celsius
+    uint16_t base_pressure;   // hPa
+    uint8_t base_humidity;    // Percent
+    uint8_t reserved[3];
+    uint32_t crc;             // CRC32 of the bytes above
+} history_segment_header_t;
+
+typedef struct {
+    uint32_t time_offset;     // Seconds after base_time, strictly increasing
+    int16_t temperature_delta;
+    int16_t pressure_delta;
+    int8_t humidity_delta;
+    uint8_t flags;            // Reserved, 0
+    uint16_t crc;             // CRC16 of the bytes above; a torn write fails it
+} history_record_t;
+
+_Static_assert(sizeof(history_segment_header_t) == 32, "segment header layout");
+_Static_assert(sizeof(history_record_t) == 12, "record layout");
+
+typedef struct {
+    time_t time;
+    float temperature;
+    int pressure;
+    int humidity;
+} history_sample_t;
+
+// Called for each sample of a range query, oldest first; return false to stop
+typedef bool (*history_visit_fn)(const history_sample_t *sample, void *ctx);
+
+esp_err_t history_init(void);
+esp_err_t history_append(const history_sample_t *sample);
+esp_err_t history_query(time_t from, time_t to, history_visit_fn visit, void *ctx);
+size_t history_count(void);
+
+#endif // HISTORY_H
@@ -0,0 +1,58 @@
+#include "http_body.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "http_body";
+
+void http_body_init(http_body_t *body, size_t limit) {
+    memset(body, 0, sizeof(*body));
+    body->limit = limit;
+}
+
+// Chunked bodies arrive already de-chunked, so both framings are collected the same way
+esp_err_t http_body_append(http_body_t *body, const void *data, size_t len) {
+    if (body->overflow || body->len + len > body->limit) {
+        if (!body->overflow) {
+            ESP_LOGE(TAG, "Response exceeds %u bytes, discarding", (unsigned)body->limit);
+        }
+        body->overflow = true;
+        return ESP_OK;
+    }
+
+    char *grown = realloc(body->data, body->len + len + 1);
+    if (grown == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate memory for response buffer");
+        return ESP_ERR_NO_MEM;
+    }
+    body->data = grown;
+    memcpy(body->data + body->len, data, len);
+    body->len += len;
+    body->data[body->len] = '\0';
+    return ESP_OK;
+}
+
+void http_body_free(http_body_t *body) {
+    free(body->data);
+    body->data = NULL;
+    body->len = 0;
+}
+
+esp_err_t http_body_check(const http_body_t *body, int status, bool complete) {
+    if (status != 200) {
+        ESP_LOGE(TAG, "HTTP GET request failed with status code: %d", status);
+        return ESP_FAIL;
+    }
+    if (body->overflow) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (!complete) {
+        ESP_LOGE(TAG, "Response truncated after %u bytes", (unsigned)body->len);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (body->data == NULL) {
+        ESP_LOGE(TAG, "Response body is empty");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
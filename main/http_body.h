@@ -0,0 +1,29 @@
+#ifndef HTTP_BODY_H
+#define HTTP_BODY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Upper bound for a response body; anything larger is rejected instead of exhausting the heap
+#define HTTP_BODY_LIMIT (16 * 1024)
+
+// Response body collected from HTTP data events, kept NUL-terminated for the parser
+typedef struct {
+    char *data;
+    size_t len;
+    size_t limit;
+    bool overflow;  // Body grew past the limit; the rest was discarded
+} http_body_t;
+
+void http_body_init(http_body_t *body, size_t limit);
+esp_err_t http_body_append(http_body_t *body, const void *data, size_t len);
+void http_body_free(http_body_t *body);
+
+// Decide whether a finished response can go to the parser: ESP_OK if so,
+// ESP_FAIL for a status other than 200 or an empty body, ESP_ERR_NO_MEM for
+// a body over the limit and ESP_ERR_INVALID_SIZE for a connection closed
+// before the whole body arrived
+esp_err_t http_body_check(const http_body_t *body, int status, bool complete);
+
+#endif // HTTP_BODY_H
@@ -0,0 +1,170 @@
+#include "metrics.h"
+#include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "metrics";
+
+#define METRICS_MAGIC   0x4d455452  // "METR"
+#define METRICS_VERSION 2
+
+typedef struct {
+    uint32_t buckets[METRICS_BUCKETS];
+    uint32_t overflow;  // Above the largest bucket
+    uint32_t count;
+    uint64_t sum_us;
+} histogram_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t boots;
+    histogram_t histograms[METRIC_HISTOGRAM_COUNT];
+    uint32_t counters[METRIC_COUNTER_COUNT];
+    uint32_t http_status[6];  // Index 1..5 for 1xx..5xx, 0 for anything else
+    uint32_t heap_low_water;  // Lowest free heap seen across boots, bytes
+    uint32_t crc;             // CRC32 of the fields above, updated with every change
+} metrics_store_t;
+
+// Not initialized at boot: survives deep sleep and software resets. After
+// power-on, a brown-out or a panic it is recognised by magic, version and CRC;
+// RAM that kept the magic but lost some counters is not exported.
+static RTC_NOINIT_ATTR metrics_store_t s_metrics;
+static portMUX_TYPE s_metrics_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *const histogram_names[METRIC_HISTOGRAM_COUNT] = {
+    [METRIC_FETCH] = "weather_fetch_latency_seconds",
+    [METRIC_WIFI_CONNECT] = "weather_wifi_connect_seconds",
+    [METRIC_PARSE] = "weather_parse_seconds",
+    [METRIC_RENDER] = "weather_render_seconds",
+};
+
+static const char *const counter_names[METRIC_COUNTER_COUNT] = {
+    [METRIC_WIFI_RETRIES] = "weather_wifi_retries_total",
+    [METRIC_WIFI_FAILURES] = "weather_wifi_failures_total",
+    [METRIC_HTTP_ERRORS] = "weather_http_transport_errors_total",
+    [METRIC_PARSE_FAILURES] = "weather_parse_failures_total",
+};
+
+static uint32_t store_crc(const metrics_store_t *store) {
+    return esp_rom_crc32_le(0, (const uint8_t *)store, offsetof(metrics_store_t, crc));
+}
+
+// Called at the end of every change, inside the critical section
+static void seal(void) {
+    s_metrics.crc = store_crc(&s_metrics);
+}
+
+void metrics_init(void) {
+    if (s_metrics.magic != METRICS_MAGIC || s_metrics.version != METRICS_VERSION ||
+        s_metrics.crc != store_crc(&s_metrics)) {
+        ESP_LOGI(TAG, "Starting new metrics store");
+        memset(&s_metrics, 0, sizeof(s_metrics));
+        s_metrics.magic = METRICS_MAGIC;
+        s_metrics.version = METRICS_VERSION;
+        s_metrics.heap_low_water = UINT32_MAX;
+    }
+    s_metrics.boots++;
+    seal();
+    metrics_sample_heap();
+}
+
+void metrics_observe(metric_histogram_t histogram, int64_t duration_us) {
+    if (duration_us < 0) {
+        duration_us = 0;
+    }
+
+    // Smallest k with duration <= 2^k
+    int bucket = 0;
+    while (bucket < METRICS_BUCKETS && duration_us > (INT64_C(1) << bucket)) {
+        bucket++;
+    }
+
+    taskENTER_CRITICAL(&s_metrics_lock);
+    histogram_t *h = &s_metrics.histograms[histogram];
+    if (bucket < METRICS_BUCKETS) {
+        h->buckets[bucket]++;
+    } else {
+        h->overflow++;
+    }
+    h->count++;
+    h->sum_us += (uint64_t)duration_us;
+    seal();
+    taskEXIT_CRITICAL(&s_metrics_lock);
+}
+
+void metrics_count(metric_counter_t counter) {
+    taskENTER_CRITICAL(&s_metrics_lock);
+    s_metrics.counters[counter]++;
+    seal();
+    taskEXIT_CRITICAL(&s_metrics_lock);
+}
+
+void metrics_http_status(int status) {
+    int status_class = status / 100;
+    if (status_class < 1 || status_class > 5) {
+        status_class = 0;
+    }
+    taskENTER_CRITICAL(&s_metrics_lock);
+    s_metrics.http_status[status_class]++;
+    seal();
+    taskEXIT_CRITICAL(&s_metrics_lock);
+}
+
+void metrics_sample_heap(void) {
+    uint32_t low = esp_get_minimum_free_heap_size();
+    taskENTER_CRITICAL(&s_metrics_lock);
+    if (low < s_metrics.heap_low_water) {
+        s_metrics.heap_low_water = low;
+        seal();
+    }
+    taskEXIT_CRITICAL(&s_metrics_lock);
+}
+
+// Prometheus text exposition format, version 0.0.4
+void metrics_dump_prometheus(FILE *out) {
+    metrics_store_t snapshot;
+
+    metrics_sample_heap();
+    taskENTER_CRITICAL(&s_metrics_lock);
+    snapshot = s_metrics;
+    taskEXIT_CRITICAL(&s_metrics_lock);
+
+    for (int i = 0; i < METRIC_HISTOGRAM_COUNT; i++) {
+        const histogram_t *h = &snapshot.histograms[i];
+        const char *name = histogram_names[i];
+        uint64_t cumulative = 0;
+
+        fprintf(out, "# TYPE %s histogram\n", name);
+        for (int bucket = 0; bucket < METRICS_BUCKETS; bucket++) {
+            cumulative += h->buckets[bucket];
+            fprintf(out, "%s_bucket{le=\"%g\"} %" PRIu64 "\n", name, (double)(INT64_C(1) << bucket) / 1e6, cumulative);
+        }
+        fprintf(out, "%s_bucket{le=\"+Inf\"} %" PRIu32 "\n", name, h->count);
+        fprintf(out, "%s_sum %.6f\n", name, h->sum_us / 1e6);
+        fprintf(out, "%s_count %" PRIu32 "\n", name, h->count);
+    }
+
+    for (int i = 0; i < METRIC_COUNTER_COUNT; i++) {
+        fprintf(out, "# TYPE %s counter\n", counter_names[i]);
+        fprintf(out, "%s %" PRIu32 "\n", counter_names[i], snapshot.counters[i]);
+    }
+
+    fprintf(out, "# TYPE weather_http_responses_total counter\n");
+    for (int i = 1; i <= 5; i++) {
+        fprintf(out, "weather_http_responses_total{class=\"%dxx\"} %" PRIu32 "\n", i, snapshot.http_status[i]);
+    }
+    fprintf(out, "weather_http_responses_total{class=\"other\"} %" PRIu32 "\n", snapshot.http_status[0]);
+
+    fprintf(out, "# TYPE weather_heap_low_water_bytes gauge\n");
+    fprintf(out, "weather_heap_low_water_bytes %" PRIu32 "\n", snapshot.heap_low_water);
+    fprintf(out, "# TYPE weather_heap_free_bytes gauge\n");
+    fprintf(out, "weather_heap_free_bytes %" PRIu32 "\n", esp_get_free_heap_size());
+    fprintf(out, "# TYPE weather_boots_total counter\n");
+    fprintf(out, "weather_boots_total %" PRIu32 "\n", snapshot.boots);
+}
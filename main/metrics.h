@@ -0,0 +1,33 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Log2-bucketed latency histograms: bucket k counts samples <= 2^k microseconds
+#define METRICS_BUCKETS 26  // Up to ~33 s, larger samples only land in +Inf
+
+typedef enum {
+    METRIC_FETCH,         // HTTP request, connect to last byte
+    METRIC_WIFI_CONNECT,  // Radio start to IP address
+    METRIC_PARSE,         // JSON parse or digest decode
+    METRIC_RENDER,        // Draw and present one frame
+    METRIC_HISTOGRAM_COUNT,
+} metric_histogram_t;
+
+typedef enum {
+    METRIC_WIFI_RETRIES,
+    METRIC_WIFI_FAILURES,
+    METRIC_HTTP_ERRORS,    // Transport errors, no HTTP status received
+    METRIC_PARSE_FAILURES,
+    METRIC_COUNTER_COUNT,
+} metric_counter_t;
+
+void metrics_init(void);
+void metrics_observe(metric_histogram_t histogram, int64_t duration_us);
+void metrics_count(metric_counter_t counter);
+void metrics_http_status(int status);
+void metrics_sample_heap(void);
+void metrics_dump_prometheus(FILE *out);
+
+#endif // METRICS_H
@@ -0,0 +1,116 @@
+#include "scheduler.h"
+#include <string.h>
+
+#define SECONDS_PER_DAY 86400
+
+static uint32_t next_random(scheduler_t *s) {
+    uint32_t x = s->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    s->rng = x;
+    return x;
+}
+
+// Uniform jitter in [0, range] seconds
+static int jitter(scheduler_t *s, int range) {
+    if (range <= 0) {
+        return 0;
+    }
+    return (int)(next_random(s) % (uint32_t)(range + 1));
+}
+
+// Spread the daily budget evenly so a burst of re-polls cannot exhaust it early
+static int minimum_gap(const scheduler_t *s) {
+    if (s->config.daily_budget <= 0) {
+        return 0;
+    }
+    return SECONDS_PER_DAY / s->config.daily_budget;
+}
+
+void scheduler_init(scheduler_t *s, const scheduler_config_t *config, time_t now, uint32_t seed) {
+    memset(s, 0, sizeof(*s));
+    s->config = *config;
+    s->rng = seed ? seed : 0x9e3779b9u;
+    s->next_fetch = now;
+    s->budget_day = (long)(now / SECONDS_PER_DAY);
+}
+
+time_t scheduler_next_fetch(const scheduler_t *s) {
+    return s->next_fetch;
+}
+
+static void roll_budget_day(scheduler_t *s, time_t now) {
+    long day = (long)(now / SECONDS_PER_DAY);
+    if (day != s->budget_day) {
+        s->budget_day = day;
+        s->calls_today = 0;
+    }
+}
+
+// Returns false and moves the schedule to the next UTC day when today's budget
+// is already spent. Checking does not use up a call.
+bool scheduler_budget_available(scheduler_t *s, time_t now) {
+    roll_budget_day(s, now);
+
+    if (s->config.daily_budget > 0 && s->calls_today >= s->config.daily_budget) {
+        time_t tomorrow = (time_t)(s->budget_day + 1) * SECONDS_PER_DAY;
+        s->next_fetch = tomorrow + jitter(s, s->config.update_margin);
+        return false;
+    }
+    return true;
+}
+
+// Account for one API call; called once the request has gone out, so a fetch
+// window that fails before reaching the provider costs nothing
+void scheduler_count_call(scheduler_t *s, time_t now) {
+    roll_budget_day(s, now);
+    s->calls_today++;
+}
+
+// Plan the next fetch just after the provider is expected to publish new data.
+// Without a valid clock "now" cannot be compared with the provider's "dt", so
+// the plain update interval is used instead.
+void scheduler_on_success(scheduler_t *s, time_t now, time_t data_dt, bool clock_valid) {
+    time_t next;
+    bool refreshed = data_dt != s->last_data_dt;
+
+    s->failures = 0;
+    s->last_data_dt = data_dt;
+
+    if (!clock_valid) {
+        next = now + s->config.update_interval;
+    } else if (data_dt > 0 && refreshed) {
+        next = data_dt + s->config.update_interval + s->config.update_margin;
+    } else {
+        // Same observation as last time: the provider is late, look again soon
+        next = now + s->config.poll_step;
+    }
+
+    if (next <= now) {
+        // Observation is older than one cadence, alignment is unknown
+        next = now + s->config.poll_step;
+    }
+
+    if (next < now + minimum_gap(s)) {
+        next = now + minimum_gap(s);
+    }
+
+    // Small jitter keeps a fleet of displays from hitting the API in lockstep
+    s->next_fetch = next + jitter(s, s->config.update_margin / 2);
+}
+
+// Exponential backoff with "equal jitter": half the delay is fixed, half random.
+void scheduler_on_failure(scheduler_t *s, time_t now) {
+    int delay = s->config.backoff_base;
+
+    for (int i = 0; i < s->failures && delay < s->config.backoff_max; i++) {
+        delay *= 2;
+    }
+    if (delay > s->config.backoff_max) {
+        delay = s->config.backoff_max;
+    }
+    s->failures++;
+
+    s->next_fetch = now + delay / 2 + jitter(s, delay / 2);
+}
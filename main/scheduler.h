@@ -0,0 +1,45 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+// Refresh planning is kept free of ESP-IDF calls so it can run on the host
+// against a virtual clock: every function takes "now" from the caller.
+typedef struct {
+    int update_interval;  // Provider update cadence in seconds
+    int update_margin;    // Wait after the expected provider update before fetching
+    int poll_step;        // Re-poll delay when the provider has not refreshed yet
+    int backoff_base;     // First retry delay after a Wi-Fi or HTTP failure
+    int backoff_max;      // Upper bound of the retry delay
+    int daily_budget;     // Maximum API calls per UTC day
+} scheduler_config_t;
+
+#define SCHEDULER_CONFIG_DEFAULT() {  \
+    .update_interval = 600,           \
+    .update_margin = 60,              \
+    .poll_step = 120,                 \
+    .backoff_base = 15,               \
+    .backoff_max = 1800,              \
+    .daily_budget = 288,              \
+}
+
+typedef struct {
+    scheduler_config_t config;
+    time_t next_fetch;
+    time_t last_data_dt;   // Provider "dt" of the last successful fetch
+    int failures;          // Consecutive failed fetches
+    long budget_day;       // UTC day the call counter belongs to
+    int calls_today;
+    uint32_t rng;          // xorshift32 state for jitter
+} scheduler_t;
+
+void scheduler_init(scheduler_t *s, const scheduler_config_t *config, time_t now, uint32_t seed);
+time_t scheduler_next_fetch(const scheduler_t *s);
+bool scheduler_budget_available(scheduler_t *s, time_t now);
+void scheduler_count_call(scheduler_t *s, time_t now);
+void scheduler_on_success(scheduler_t *s, time_t now, time_t data_dt, bool clock_valid);
+void scheduler_on_failure(scheduler_t *s, time_t now);
+
+#endif // SCHEDULER_H
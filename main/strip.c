@@ -0,0 +1,123 @@
+#include "strip.h"
+#include <string.h>
+#include "bsp/esp-bsp.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "trace.h"
+
+static const char *TAG = "strip";
+
+// Runs in ISR context when the panel IO has finished sending a band
+static bool IRAM_ATTR on_transfer_done(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx) {
+    strip_renderer_t *strip = user_ctx;
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(strip->transfer_done, &woken);
+    return woken == pdTRUE;
+}
+
+esp_err_t strip_init(strip_renderer_t *strip, int width, int height, int band_rows) {
+    memset(strip, 0, sizeof(*strip));
+    strip->width = width;
+    strip->height = height;
+    strip->band_rows = band_rows;
+
+    size_t band_size = (size_t)width * band_rows * sizeof(uint16_t);
+    for (int i = 0; i < 2; i++) {
+        strip->buffers[i] = heap_caps_malloc(band_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (strip->buffers[i] == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate %u byte band buffer", (unsigned)band_size);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    strip->transfer_done = xSemaphoreCreateCounting(2, 0);
+    if (strip->transfer_done == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    const bsp_display_config_t config = {
+        .max_transfer_sz = band_size,
+    };
+    ESP_RETURN_ON_ERROR(bsp_display_new(&config, &strip->panel, &strip->io), TAG, "Display init failed");
+
+    const esp_lcd_panel_io_callbacks_t callbacks = {
+        .on_color_trans_done = on_transfer_done,
+    };
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_register_event_callbacks(strip->io, &callbacks, strip), TAG, "Callback registration failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_disp_on_off(strip->panel, true), TAG, "Display on failed");
+    bsp_display_backlight_on();
+
+    if (!strip_band_init(&strip->band, width, height, band_rows, strip->buffers[0])) {
+        return ESP_FAIL;
+    }
+    strip->renderer = strip->band.renderer;
+
+    ESP_LOGI(TAG, "Strip renderer %dx%d, %d rows per band, 2 x %u bytes DMA RAM",
+             width, height, band_rows, (unsigned)band_size);
+    return ESP_OK;
+}
+
+static void wait_transfer(strip_renderer_t *strip) {
+    int64_t start = esp_timer_get_time();
+    xSemaphoreTake(strip->transfer_done, portMAX_DELAY);
+    strip->in_flight--;
+    strip->wait_us += esp_timer_get_time() - start;
+}
+
+// SDL stores RGB565 little-endian, SPI panels take it big-endian
+static void swap_bytes(uint16_t *pixels, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        pixels[i] = (uint16_t)((pixels[i] << 8) | (pixels[i] >> 8));
+    }
+}
+
+// Draw the scene band by band, sending each band while the next one is drawn
+void strip_render(strip_renderer_t *strip, strip_draw_fn draw, void *ctx) {
+    int64_t frame_start = esp_timer_get_time();
+
+    for (int y = 0, band = 0; y < strip->height; y += strip->band_rows, band++) {
+        int rows = SDL_min(strip->band_rows, strip->height - y);
+        uint16_t *buffer = strip->buffers[band & 1];
+
+        // Transfers finish in order, so with both buffers queued the oldest one is ours
+        if (strip->in_flight == 2) {
+            wait_transfer(strip);
+        }
+
+        int64_t render_start = esp_timer_get_time();
+        TRACE_BEGIN("band");
+        strip_band_draw(&strip->band, buffer, y, draw, ctx);
+        swap_bytes(buffer, (size_t)strip->width * rows);
+        TRACE_END("band");
+        strip->render_us += esp_timer_get_time() - render_start;
+
+        esp_lcd_panel_draw_bitmap(strip->panel, 0, y, strip->width, y + rows, buffer);
+        strip->in_flight++;
+    }
+
+    // The frame is on the glass before the caller reports it as presented
+    while (strip->in_flight > 0) {
+        wait_transfer(strip);
+    }
+
+    strip->frames++;
+    strip->frame_us += esp_timer_get_time() - frame_start;
+}
+
+void strip_log_stats(strip_renderer_t *strip) {
+    if (strip->frames == 0) {
+        return;
+    }
+    double frame_ms = strip->frame_us / 1000.0 / strip->frames;
+    ESP_LOGI(TAG, "%d frames: %.1f ms per frame (%.1f fps), drawing %.1f ms, waiting for DMA %.1f ms",
+             strip->frames, frame_ms, 1000.0 / frame_ms,
+             strip->render_us / 1000.0 / strip->frames,
+             strip->wait_us / 1000.0 / strip->frames);
+    strip->frames = 0;
+    strip->frame_us = 0;
+    strip->render_us = 0;
+    strip->wait_us = 0;
+}
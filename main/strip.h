@@ -0,0 +1,38 @@
+#ifndef STRIP_H
+#define STRIP_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_ops.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "SDL3/SDL.h"
+#include "strip_band.h"
+
+typedef struct {
+    esp_lcd_panel_handle_t panel;
+    esp_lcd_panel_io_handle_t io;
+    int width;
+    int height;
+    int band_rows;
+
+    // Two bands in DMA-capable internal RAM: one is drawn while the other is sent
+    uint16_t *buffers[2];
+    strip_band_t band;
+    SDL_Renderer *renderer; // band.renderer, for code that only draws
+    SemaphoreHandle_t transfer_done;
+    int in_flight;
+
+    // Totals since the last strip_log_stats
+    int frames;
+    int64_t frame_us;
+    int64_t render_us;
+    int64_t wait_us;
+} strip_renderer_t;
+
+esp_err_t strip_init(strip_renderer_t *strip, int width, int height, int band_rows);
+void strip_render(strip_renderer_t *strip, strip_draw_fn draw, void *ctx);
+void strip_log_stats(strip_renderer_t *strip);
+
+#endif // STRIP_H
@@ -0,0 +1,50 @@
+#include "strip_band.h"
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "strip";
+
+// Software renderer over one band of RGB565 rows
+bool strip_band_init(strip_band_t *band, int width, int height, int rows, void *pixels) {
+    memset(band, 0, sizeof(*band));
+    band->width = width;
+    band->height = height;
+    band->rows = rows;
+
+    // Lines as Bresenham points: each pixel depends on the line alone, not on
+    // which band clips it, so a line crossing a band edge has no seam
+    SDL_SetHint(SDL_HINT_RENDER_LINE_METHOD, "1");
+
+    band->surface = SDL_CreateSurfaceFrom(width, rows, SDL_PIXELFORMAT_RGB565, pixels, width * 2);
+    if (band->surface == NULL) {
+        ESP_LOGE(TAG, "Failed to create band surface: %s", SDL_GetError());
+        return false;
+    }
+    band->renderer = SDL_CreateSoftwareRenderer(band->surface);
+    if (band->renderer == NULL) {
+        ESP_LOGE(TAG, "Failed to create band renderer: %s", SDL_GetError());
+        SDL_DestroySurface(band->surface);
+        band->surface = NULL;
+        return false;
+    }
+    return true;
+}
+
+// Draw rows y..y+rows of the scene into pixels
+void strip_band_draw(strip_band_t *band, void *pixels, int y, strip_draw_fn draw, void *ctx) {
+    band->surface->pixels = pixels;
+    SDL_Rect viewport = {0, -y, band->width, band->height};
+    SDL_SetRenderViewport(band->renderer, &viewport);
+    draw(band->renderer, ctx);
+    SDL_FlushRenderer(band->renderer);
+}
+
+void strip_band_deinit(strip_band_t *band) {
+    if (band->renderer != NULL) {
+        SDL_DestroyRenderer(band->renderer);
+    }
+    if (band->surface != NULL) {
+        SDL_DestroySurface(band->surface);
+    }
+    memset(band, 0, sizeof(*band));
+}
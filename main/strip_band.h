@@ -0,0 +1,25 @@
+#ifndef STRIP_BAND_H
+#define STRIP_BAND_H
+
+#include "SDL3/SDL.h"
+
+// Drawing side of the strip renderer, free of the panel driver so the host
+// tests can compare banded output with whole-frame rendering
+
+// Scene callback; called once per band with the viewport shifted so that the
+// scene is drawn in full-screen coordinates
+typedef void (*strip_draw_fn)(SDL_Renderer *renderer, void *ctx);
+
+typedef struct {
+    SDL_Surface *surface;   // Points at whichever band buffer is being drawn
+    SDL_Renderer *renderer;
+    int width;
+    int height;             // Of the whole screen
+    int rows;               // Of one band
+} strip_band_t;
+
+bool strip_band_init(strip_band_t *band, int width, int height, int rows, void *pixels);
+void strip_band_draw(strip_band_t *band, void *pixels, int y, strip_draw_fn draw, void *ctx);
+void strip_band_deinit(strip_band_t *band);
+
+#endif // STRIP_BAND_H
@@ -0,0 +1,158 @@
+#include "timesync.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_sntp.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+
+static const char *TAG = "timesync";
+
+// Assumed worst-case RTC drift and the clock error we are willing to accept.
+// While the last sync is younger than the tolerance left after that sync's
+// own error, divided by the drift, SNTP is skipped.
+#define TIME_DRIFT_PPM          100
+#define TIME_DRIFT_TOLERANCE_S  2
+#define TIME_DRIFT_TOLERANCE_MS (TIME_DRIFT_TOLERANCE_S * 1000)
+
+// The HTTP Date header has whole seconds, truncated, and arrives after the
+// response latency; an SNTP sync is counted as exact
+#define TIME_HTTP_DATE_ERROR_MS 1500
+
+// Anything before 2016-01-01 is an unset clock
+#define TIME_VALID_EPOCH 1451606400
+
+#define TIME_SYNCED_BIT BIT0
+
+// Kept in RTC memory next to the RTC-maintained system time, survives deep sleep
+RTC_DATA_ATTR static time_t s_last_sync;
+RTC_DATA_ATTR static int32_t s_last_sync_error_ms;
+
+static EventGroupHandle_t s_time_event_group;
+static bool s_sntp_running = false;
+
+static void record_sync(time_t when, int32_t error_ms) {
+    s_last_sync = when;
+    s_last_sync_error_ms = error_ms;
+    if (s_time_event_group != NULL) {
+        xEventGroupSetBits(s_time_event_group, TIME_SYNCED_BIT);
+    }
+}
+
+static void time_sync_notification(struct timeval *tv) {
+    ESP_LOGI(TAG, "Time synchronized by SNTP");
+    record_sync(tv->tv_sec, 0);
+}
+
+bool time_sync_is_valid(void) {
+    return time(NULL) >= TIME_VALID_EPOCH;
+}
+
+static bool time_sync_is_fresh(void) {
+    time_t now = time(NULL);
+    int64_t max_age_s = (TIME_DRIFT_TOLERANCE_MS - (int64_t)s_last_sync_error_ms) * 1000 / TIME_DRIFT_PPM;
+    return time_sync_is_valid() && s_last_sync > 0 && now >= s_last_sync &&
+           now - s_last_sync < max_age_s;
+}
+
+// Start SNTP in the background; completion is signalled by the notification callback
+void time_sync_start(void) {
+    if (s_time_event_group == NULL) {
+        s_time_event_group = xEventGroupCreate();
+    }
+
+    if (time_sync_is_fresh()) {
+        ESP_LOGI(TAG, "RTC time within drift tolerance, skipping SNTP");
+        xEventGroupSetBits(s_time_event_group, TIME_SYNCED_BIT);
+        return;
+    }
+
+    if (s_sntp_running) {
+        return;
+    }
+
+    ESP_LOGI(TAG, "Starting SNTP");
+    xEventGroupClearBits(s_time_event_group, TIME_SYNCED_BIT);
+    esp_sntp_setoperatingmode(SNTP_OPMODE_POLL);
+    esp_sntp_setservername(0, "pool.ntp.org"); // Use default NTP server
+    sntp_set_time_sync_notification_cb(time_sync_notification);
+    esp_sntp_init();
+    s_sntp_running = true;
+}
+
+void time_sync_stop(void) {
+    if (s_sntp_running) {
+        esp_sntp_stop();
+        s_sntp_running = false;
+    }
+}
+
+esp_err_t time_sync_wait(int timeout_ms) {
+    if (s_time_event_group == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    EventBits_t bits = xEventGroupWaitBits(s_time_event_group, TIME_SYNCED_BIT,
+                                           pdFALSE, pdFALSE, pdMS_TO_TICKS(timeout_ms));
+    return (bits & TIME_SYNCED_BIT) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date (newlib has no timegm)
+static long days_from_civil(int y, int m, int d) {
+    y -= m <= 2;
+    long era = (y >= 0 ? y : y - 399) / 400;
+    long yoe = y - era * 400;
+    long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+// Fallback time source: HTTP "Date" header, e.g. "Sun, 06 Nov 1994 08:49:37 GMT".
+// Only applied while SNTP has not produced a fresh time. Counts as a sync with
+// TIME_HTTP_DATE_ERROR_MS of error, so it stays fresh for a shorter time than
+// an SNTP sync and ends the wait for SNTP in this fetch window.
+esp_err_t time_sync_from_http_date(const char *date) {
+    static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    char month[4];
+    int day, year, hour, minute, second;
+
+    if (time_sync_is_fresh()) {
+        return ESP_OK;
+    }
+
+    if (sscanf(date, "%*3s, %d %3s %d %d:%d:%d", &day, month, &year, &hour, &minute, &second) != 6) {
+        ESP_LOGW(TAG, "Unrecognized HTTP date: %s", date);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const char *found = strstr(months, month);
+    if (found == NULL || (found - months) % 3 != 0) {
+        ESP_LOGW(TAG, "Unrecognized HTTP date: %s", date);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int mon = (int)(found - months) / 3 + 1;
+    struct timeval tv = {
+        .tv_sec = (time_t)days_from_civil(year, mon, day) * 86400 + hour * 3600 + minute * 60 + second,
+        .tv_usec = 0,
+    };
+
+    // A clock that agrees is left alone but counts as checked, with its
+    // distance to the header added to the header's own error
+    time_t now = time(NULL);
+    long long offset_s = llabs((long long)(tv.tv_sec - now));
+    if (time_sync_is_valid() && offset_s <= TIME_DRIFT_TOLERANCE_S) {
+        int64_t error_ms = offset_s * 1000 + TIME_HTTP_DATE_ERROR_MS;
+        if (error_ms < TIME_DRIFT_TOLERANCE_MS) {
+            record_sync(now, (int32_t)error_ms);
+        }
+        return ESP_OK;
+    }
+
+    settimeofday(&tv, NULL);
+    record_sync(tv.tv_sec, TIME_HTTP_DATE_ERROR_MS);
+    ESP_LOGI(TAG, "Time set from HTTP Date header: %s", date);
+    return ESP_OK;
+}
@@ -0,0 +1,14 @@
+#ifndef TIMESYNC_H
+#define TIMESYNC_H
+
+#include <stdbool.h>
+#include <time.h>
+#include "esp_err.h"
+
+void time_sync_start(void);
+void time_sync_stop(void);
+bool time_sync_is_valid(void);
+esp_err_t time_sync_wait(int timeout_ms);
+esp_err_t time_sync_from_http_date(const char *date);
+
+#endif // TIMESYNC_H
@@ -0,0 +1,85 @@
+#include "touch.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "SDL3/SDL.h"
+#include "bsp/esp-bsp.h"
+
+static const char *TAG = "touch";
+
+#if BSP_CAPS_TOUCH
+#include "esp_lcd_touch.h"
+
+static esp_lcd_touch_handle_t s_touch;
+static int s_width;
+static int s_height;
+
+// Thread safe: SDL_PushEvent may be called from this task
+static void push_finger(Uint32 type, uint16_t x, uint16_t y) {
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = type;
+    event.common.timestamp = SDL_GetTicksNS();
+    event.tfinger.touchID = 1;
+    event.tfinger.fingerID = 1;
+    event.tfinger.x = (float)x / s_width;
+    event.tfinger.y = (float)y / s_height;
+    event.tfinger.pressure = type == SDL_EVENT_FINGER_UP ? 0.0f : 1.0f;
+    SDL_PushEvent(&event);
+}
+
+// Report press and release of the first touch point. Movement in between is
+// not sent: gestures are classified from the two ends, and motion events
+// would only wake the render loop.
+static void touch_task(void *arg) {
+    bool pressed = false;
+    uint16_t last_x = 0;
+    uint16_t last_y = 0;
+
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(TOUCH_POLL_MS));
+        if (esp_lcd_touch_read_data(s_touch) != ESP_OK) {
+            continue;
+        }
+
+        uint16_t x, y, strength;
+        uint8_t count = 0;
+        esp_lcd_touch_get_coordinates(s_touch, &x, &y, &strength, &count, 1);
+        if (count > 0) {
+            if (!pressed) {
+                push_finger(SDL_EVENT_FINGER_DOWN, x, y);
+                pressed = true;
+            }
+            last_x = x;
+            last_y = y;
+        } else if (pressed) {
+            push_finger(SDL_EVENT_FINGER_UP, last_x, last_y);
+            pressed = false;
+        }
+    }
+}
+
+esp_err_t touch_init(int width, int height) {
+    esp_err_t err = bsp_touch_new(NULL, &s_touch);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Touch controller init failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    s_width = width;
+    s_height = height;
+
+    if (xTaskCreate(touch_task, "touch", 3072, NULL, 5, NULL) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Polling touch controller every %d ms", TOUCH_POLL_MS);
+    return ESP_OK;
+}
+
+#else
+
+esp_err_t touch_init(int width, int height) {
+    ESP_LOGI(TAG, "No touch controller on this board");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif
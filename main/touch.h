@@ -0,0 +1,13 @@
+#ifndef TOUCH_H
+#define TOUCH_H
+
+#include "esp_err.h"
+
+// Poll the board's touch controller and feed it to SDL as finger events, so
+// touches reach the render loop like any other SDL input. The SDL port only
+// drives the panel, and the strip renderer has no SDL window at all.
+#define TOUCH_POLL_MS 10  // Controllers report at about 100 Hz
+
+esp_err_t touch_init(int width, int height);
+
+#endif // TOUCH_H
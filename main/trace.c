@@ -0,0 +1,112 @@
+#include "trace.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef CONFIG_WEATHER_TRACE
+
+#define TRACE_EVENTS CONFIG_WEATHER_TRACE_EVENTS
+#define TRACE_MAX_TASKS 16
+
+typedef struct {
+    const char *name;
+    TaskHandle_t task;
+    int64_t timestamp_us;
+    char phase;
+    atomic_uint sequence;  // Written last; identifies which lap of the ring this slot holds
+} trace_event_t;
+
+static trace_event_t s_events[TRACE_EVENTS];
+static atomic_uint s_head;
+
+// Lock-free: each writer claims a slot with one atomic increment, then
+// publishes it by storing the sequence number with release ordering. The
+// fences pair the slot like a seqlock: the reader's second sequence load
+// cannot move before its copy of the fields, nor the writer's field stores
+// before its reset of the sequence.
+void trace_record(const char *name, char phase) {
+    unsigned index = atomic_fetch_add_explicit(&s_head, 1, memory_order_relaxed);
+    trace_event_t *event = &s_events[index % TRACE_EVENTS];
+
+    atomic_store_explicit(&event->sequence, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    event->name = name;
+    event->task = xTaskGetCurrentTaskHandle();
+    event->timestamp_us = esp_timer_get_time();
+    event->phase = phase;
+    atomic_store_explicit(&event->sequence, index + 1, memory_order_release);
+}
+
+void trace_clear(void) {
+    atomic_store(&s_head, 0);
+    for (int i = 0; i < TRACE_EVENTS; i++) {
+        atomic_store_explicit(&s_events[i].sequence, 0, memory_order_relaxed);
+    }
+}
+
+// Print the ring as Chrome trace-event JSON. Slots being rewritten while the
+// dump runs are skipped by checking their sequence number.
+void trace_dump_json(FILE *out) {
+    TaskHandle_t tasks[TRACE_MAX_TASKS];
+    int task_count = 0;
+    unsigned head = atomic_load(&s_head);
+    unsigned first = head > TRACE_EVENTS ? head - TRACE_EVENTS : 0;
+    bool comma = false;
+
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    for (unsigned index = first; index < head; index++) {
+        const trace_event_t *event = &s_events[index % TRACE_EVENTS];
+        if (atomic_load_explicit(&event->sequence, memory_order_acquire) != index + 1) {
+            continue;
+        }
+        const char *name = event->name;
+        TaskHandle_t task = event->task;
+        long long timestamp = event->timestamp_us;
+        char phase = event->phase;
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&event->sequence, memory_order_relaxed) != index + 1) {
+            continue;
+        }
+
+        bool known = false;
+        for (int i = 0; i < task_count; i++) {
+            known |= tasks[i] == task;
+        }
+        if (!known && task_count < TRACE_MAX_TASKS) {
+            tasks[task_count++] = task;
+        }
+
+        fprintf(out, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lld,\"pid\":1,\"tid\":%u}",
+                comma ? ",\n" : "", name, phase, timestamp, (unsigned)(uintptr_t)task);
+        comma = true;
+    }
+
+    // Thread name metadata so the viewer shows task names instead of handles
+    for (int i = 0; i < task_count; i++) {
+        fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                comma ? ",\n" : "", (unsigned)(uintptr_t)tasks[i], pcTaskGetName(tasks[i]));
+        comma = true;
+    }
+
+    fprintf(out, "\n]}\n");
+}
+
+#else
+
+void trace_record(const char *name, char phase) {
+    (void)name;
+    (void)phase;
+}
+
+void trace_clear(void) {
+}
+
+void trace_dump_json(FILE *out) {
+    fprintf(out, "Tracing is disabled, enable CONFIG_WEATHER_TRACE\n");
+}
+
+#endif // CONFIG_WEATHER_TRACE
@@ -0,0 +1,20 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include "sdkconfig.h"
+
+// Span tracing. Names must be string literals: only the pointer is stored.
+#ifdef CONFIG_WEATHER_TRACE
+#define TRACE_BEGIN(name) trace_record((name), 'B')
+#define TRACE_END(name)   trace_record((name), 'E')
+#else
+#define TRACE_BEGIN(name) do { } while (0)
+#define TRACE_END(name)   do { } while (0)
+#endif
+
+void trace_record(const char *name, char phase);
+void trace_dump_json(FILE *out);
+void trace_clear(void);
+
+#endif // TRACE_H
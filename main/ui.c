@@ -0,0 +1,159 @@
+#include "ui.h"
+#include <string.h>
+#include "esp_log.h"
+#include "graphics.h"
+
+static const char *TAG = "ui";
+
+#define FRAME_INTERVAL_NS (SDL_NS_PER_SECOND / PANEL_REFRESH_HZ)
+
+// Registered SDL event type used by the fetch task to wake the render loop
+static Uint32 s_weather_event = 0;
+
+void ui_init(ui_state_t *ui, int width, int height) {
+    memset(ui, 0, sizeof(*ui));
+    ui->page = WEATHER_PAGE_CURRENT;
+    ui->width = width;
+    ui->height = height;
+
+    if (s_weather_event == 0) {
+        s_weather_event = SDL_RegisterEvents(1);
+    }
+}
+
+// Thread safe: SDL_PushEvent may be called from the scheduler task
+void ui_notify_weather_updated(void) {
+    if (s_weather_event == 0) {
+        return;
+    }
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = s_weather_event;
+    event.common.timestamp = SDL_GetTicksNS();
+    SDL_PushEvent(&event);
+}
+
+static void mark_input(ui_state_t *ui, Uint64 timestamp) {
+    ui->dirty = true;
+    if (ui->pending_input_ns == 0) {
+        ui->pending_input_ns = timestamp;
+    }
+}
+
+static void touch_down(ui_state_t *ui, float x, float y) {
+    ui->pressed = true;
+    ui->down_x = x;
+    ui->down_y = y;
+}
+
+// Classify the finished touch as a swipe (page change) or a tap (detail view)
+static bool touch_up(ui_state_t *ui, float x, float y, Uint64 timestamp) {
+    if (!ui->pressed) {
+        return false;
+    }
+    ui->pressed = false;
+
+    float dx = x - ui->down_x;
+    float dy = y - ui->down_y;
+
+    if (SDL_fabsf(dx) >= UI_SWIPE_MIN_PX && SDL_fabsf(dx) > SDL_fabsf(dy)) {
+        int step = dx < 0 ? 1 : -1;
+        ui->page = (ui->page + step + WEATHER_PAGE_COUNT) % WEATHER_PAGE_COUNT;
+        ui->direction = step;
+        ui->detail = false;
+        mark_input(ui, timestamp);
+        ESP_LOGD(TAG, "Swipe to page %d", ui->page);
+        return true;
+    }
+
+    if (SDL_fabsf(dx) <= UI_TAP_MAX_PX && SDL_fabsf(dy) <= UI_TAP_MAX_PX) {
+        ui->detail = !ui->detail;
+        mark_input(ui, timestamp);
+        ESP_LOGD(TAG, "Detail view %s", ui->detail ? "on" : "off");
+        return true;
+    }
+
+    return false;
+}
+
+// Feed one SDL event; returns true when the view has to be redrawn
+bool ui_handle_event(ui_state_t *ui, const SDL_Event *event) {
+    if (event->type == s_weather_event) {
+        ui->dirty = true;
+        ui->weather_updated = true;
+        return true;
+    }
+
+    switch (event->type) {
+        case SDL_EVENT_FINGER_DOWN:
+            touch_down(ui, event->tfinger.x * ui->width, event->tfinger.y * ui->height);
+            break;
+        case SDL_EVENT_FINGER_UP:
+            return touch_up(ui, event->tfinger.x * ui->width, event->tfinger.y * ui->height,
+                            event->common.timestamp);
+        case SDL_EVENT_MOUSE_BUTTON_DOWN:
+            // Touch is already handled through finger events
+            if (event->button.which != SDL_TOUCH_MOUSEID) {
+                touch_down(ui, event->button.x, event->button.y);
+            }
+            break;
+        case SDL_EVENT_MOUSE_BUTTON_UP:
+            if (event->button.which != SDL_TOUCH_MOUSEID) {
+                return touch_up(ui, event->button.x, event->button.y, event->common.timestamp);
+            }
+            break;
+        case SDL_EVENT_WINDOW_EXPOSED:
+            ui->dirty = true;
+            return true;
+        default:
+            break;
+    }
+    return false;
+}
+
+// How long the loop may block waiting for events: -1 when idle, otherwise the
+// time left until the panel can take the next frame.
+int ui_frame_timeout_ms(const ui_state_t *ui, Uint64 now_ns) {
+    if (!ui->dirty) {
+        return -1;
+    }
+    Uint64 due = ui->last_present_ns + FRAME_INTERVAL_NS;
+    if (ui->last_present_ns == 0 || now_ns >= due) {
+        return 0;
+    }
+    return (int)((due - now_ns + SDL_NS_PER_MS - 1) / SDL_NS_PER_MS);
+}
+
+void ui_frame_presented(ui_state_t *ui, Uint64 now_ns) {
+    ui->dirty = false;
+    ui->last_present_ns = now_ns;
+
+    if (ui->pending_input_ns == 0) {
+        return;
+    }
+
+    Uint64 latency = now_ns - ui->pending_input_ns;
+    ui->pending_input_ns = 0;
+
+    if (ui->latency_count == 0 || latency < ui->latency_min_ns) {
+        ui->latency_min_ns = latency;
+    }
+    if (latency > ui->latency_max_ns) {
+        ui->latency_max_ns = latency;
+    }
+    ui->latency_sum_ns += latency;
+    ui->latency_count++;
+
+    ESP_LOGI(TAG, "Input-to-photon: %.1f ms", latency / 1e6);
+}
+
+void ui_log_latency(const ui_state_t *ui) {
+    if (ui->latency_count == 0) {
+        return;
+    }
+    ESP_LOGI(TAG, "Input-to-photon over %d inputs: min %.1f ms, avg %.1f ms, max %.1f ms",
+             ui->latency_count,
+             ui->latency_min_ns / 1e6,
+             (ui->latency_sum_ns / ui->latency_count) / 1e6,
+             ui->latency_max_ns / 1e6);
+}
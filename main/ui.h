@@ -0,0 +1,48 @@
+#ifndef UI_H
+#define UI_H
+
+#include <stdbool.h>
+#include "SDL3/SDL.h"
+
+// Frames are never presented faster than the panel can show them
+#ifdef DISPLAY_EPAPER
+#define PANEL_REFRESH_HZ 1
+#else
+#define PANEL_REFRESH_HZ 60
+#endif
+
+#define UI_SWIPE_MIN_PX 40   // Horizontal travel that turns a touch into a swipe
+#define UI_TAP_MAX_PX   15   // Movement still accepted as a tap
+
+typedef struct {
+    int page;
+    bool detail;
+    int direction;           // Last swipe: +1 to the next page, -1 to the previous
+    bool dirty;              // Something changed since the last present
+    bool weather_updated;    // New data arrived since the last present
+
+    // Touch tracking for gesture recognition
+    bool pressed;
+    float down_x;
+    float down_y;
+
+    // Input-to-photon measurement
+    Uint64 pending_input_ns; // Timestamp of the oldest unpresented input, 0 if none
+    Uint64 last_present_ns;
+    int latency_count;
+    Uint64 latency_sum_ns;
+    Uint64 latency_min_ns;
+    Uint64 latency_max_ns;
+
+    int width;
+    int height;
+} ui_state_t;
+
+void ui_init(ui_state_t *ui, int width, int height);
+void ui_notify_weather_updated(void);
+bool ui_handle_event(ui_state_t *ui, const SDL_Event *event);
+int ui_frame_timeout_ms(const ui_state_t *ui, Uint64 now_ns);
+void ui_frame_presented(ui_state_t *ui, Uint64 now_ns);
+void ui_log_latency(const ui_state_t *ui);
+
+#endif // UI_H
@@ -1,3 +1,14 @@
 #include "weather.h"
+#include <pthread.h>
 
-weather_info_t current_weather;
\ No newline at end of file
+weather_info_t current_weather;
+
+static pthread_mutex_t weather_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+void weather_lock(void) {
+    pthread_mutex_lock(&weather_mutex);
+}
+
+void weather_unlock(void) {
+    pthread_mutex_unlock(&weather_mutex);
+}
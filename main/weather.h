@@ -10,6 +10,7 @@ typedef struct {
     float temperature;
     int pressure;
     int humidity;
+    time_t dt;      // Provider observation time
     time_t sunrise; // Update to time_t
     time_t sunset;  // Update to time_t
     int sunrise_hour;
@@ -21,4 +22,8 @@ typedef struct {
 
 extern weather_info_t current_weather;
 
+// Guard current_weather between the fetch task and the render thread
+void weather_lock(void);
+void weather_unlock(void);
+
 #endif
@@ -0,0 +1,82 @@
+#include "weather_digest.h"
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "digest";
+
+static uint16_t read_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t read_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int64_t read_i64(const uint8_t *p) {
+    return (int64_t)((uint64_t)read_u32(p) | ((uint64_t)read_u32(p + 4) << 32));
+}
+
+// Bitwise CRC-32, same polynomial and conditioning as zlib.crc32
+static uint32_t crc32(const uint8_t *data, size_t len) {
+    uint32_t crc = 0xFFFFFFFFu;
+    while (len--) {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+static void copy_string(char *dst, size_t dst_size, const uint8_t *src, size_t src_size) {
+    size_t len = strnlen((const char *)src, src_size);
+    if (len >= dst_size) {
+        len = dst_size - 1;
+    }
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+}
+
+// Validate a gateway record and fill the model. The model is untouched on error.
+esp_err_t weather_digest_decode(const uint8_t *data, size_t len, weather_info_t *weather) {
+    if (len < WEATHER_DIGEST_HEADER_SIZE || memcmp(data, WEATHER_DIGEST_MAGIC, 4) != 0) {
+        ESP_LOGE(TAG, "Not a weather digest (%u bytes)", (unsigned)len);
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    uint16_t version = read_u16(data + 4);
+    uint16_t size = read_u16(data + 6);
+    if (version != WEATHER_DIGEST_VERSION) {
+        ESP_LOGE(TAG, "Unsupported digest version %u", version);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    // Later revisions may append fields; the v1 prefix must be complete
+    if (size < WEATHER_DIGEST_V1_SIZE || size > len) {
+        ESP_LOGE(TAG, "Digest size %u invalid for %u bytes received", size, (unsigned)len);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (crc32(data + WEATHER_DIGEST_HEADER_SIZE, size - WEATHER_DIGEST_HEADER_SIZE) != read_u32(data + 8)) {
+        ESP_LOGE(TAG, "Digest CRC mismatch");
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    weather->dt = (time_t)read_i64(data + 12);
+    weather->sunrise = (time_t)read_i64(data + 20);
+    weather->sunset = (time_t)read_i64(data + 28);
+    weather->temperature = (int16_t)read_u16(data + 36) / 100.0f;
+    weather->pressure = read_u16(data + 38);
+    weather->humidity = data[40];
+    copy_string(weather->icon, sizeof(weather->icon), data + 44, 8);
+    copy_string(weather->description, sizeof(weather->description), data + 52, 64);
+
+    struct tm local;
+    if (localtime_r(&weather->sunrise, &local) != NULL) {
+        weather->sunrise_hour = local.tm_hour;
+        weather->sunrise_minute = local.tm_min;
+    }
+    if (localtime_r(&weather->sunset, &local) != NULL) {
+        weather->sunset_hour = local.tm_hour;
+        weather->sunset_minute = local.tm_min;
+    }
+    return ESP_OK;
+}
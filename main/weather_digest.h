@@ -0,0 +1,34 @@
+#ifndef WEATHER_DIGEST_H
+#define WEATHER_DIGEST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "weather.h"
+
+// Fixed-layout record served by tools/digest_gateway.py at /digest.
+// All fields little-endian; the CRC-32 (zlib polynomial) covers every byte
+// after the 12-byte header up to "size".
+//
+//   offset  size  field
+//        0     4  magic "WDGT"
+//        4     2  version
+//        6     2  size of the whole record
+//        8     4  crc32
+//       12     8  dt (observation time, Unix seconds)
+//       20     8  sunrise
+//       28     8  sunset
+//       36     2  temperature, hundredths of a degree Celsius (signed)
+//       38     2  pressure, hPa
+//       40     1  humidity, %
+//       41     3  reserved
+//       44     8  icon, NUL padded
+//       52    64  description, NUL padded UTF-8
+#define WEATHER_DIGEST_MAGIC       "WDGT"
+#define WEATHER_DIGEST_VERSION     1
+#define WEATHER_DIGEST_HEADER_SIZE 12
+#define WEATHER_DIGEST_V1_SIZE     116
+
+esp_err_t weather_digest_decode(const uint8_t *data, size_t len, weather_info_t *weather);
+
+#endif // WEATHER_DIGEST_H
@@ -0,0 +1,138 @@
+#include "weather_json.h"
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "cJSON.h"
+#include "esp_log.h"
+
+static const char *TAG = "weather_json";
+
+// Latest time accepted from the provider, year 9999; keeps the time_t conversion defined
+#define WEATHER_JSON_MAX_TIME 253402300799.0
+
+// Each getter returns false for a missing field and logs one of the wrong type,
+// so a change on the provider side cannot make us read the wrong cJSON member
+static bool get_string(const cJSON *object, const char *name, char *dst, size_t dst_size) {
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(object, name);
+    if (item == NULL) {
+        return false;
+    }
+    if (!cJSON_IsString(item) || item->valuestring == NULL) {
+        ESP_LOGW(TAG, "Ignoring \"%s\": not a string", name);
+        return false;
+    }
+    snprintf(dst, dst_size, "%s", item->valuestring);
+    return true;
+}
+
+static bool get_number(const cJSON *object, const char *name, double min, double max, double *value) {
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(object, name);
+    if (item == NULL) {
+        return false;
+    }
+    if (!cJSON_IsNumber(item)) {
+        ESP_LOGW(TAG, "Ignoring \"%s\": not a number", name);
+        return false;
+    }
+    if (!(item->valuedouble >= min && item->valuedouble <= max)) {
+        ESP_LOGW(TAG, "Ignoring \"%s\": %g out of range", name, item->valuedouble);
+        return false;
+    }
+    *value = item->valuedouble;
+    return true;
+}
+
+static bool get_int(const cJSON *object, const char *name, int *value) {
+    double number;
+    if (!get_number(object, name, INT_MIN, INT_MAX, &number)) {
+        return false;
+    }
+    *value = (int)number;
+    return true;
+}
+
+static bool get_time(const cJSON *object, const char *name, time_t *value) {
+    double number;
+    if (!get_number(object, name, 0.0, WEATHER_JSON_MAX_TIME, &number)) {
+        return false;
+    }
+    *value = (time_t)number;
+    return true;
+}
+
+static const cJSON *get_object(const cJSON *object, const char *name) {
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(object, name);
+    if (item != NULL && !cJSON_IsObject(item)) {
+        ESP_LOGW(TAG, "Ignoring \"%s\": not an object", name);
+        return NULL;
+    }
+    return item;
+}
+
+static void set_local_time(time_t time, int *hour, int *minute) {
+    struct tm local;
+    if (localtime_r(&time, &local) != NULL) {
+        *hour = local.tm_hour;
+        *minute = local.tm_min;
+    }
+}
+
+esp_err_t weather_parse_json(const char *json, weather_info_t *weather) {
+    cJSON *root = cJSON_Parse(json);
+    if (root == NULL) {
+        ESP_LOGE(TAG, "Failed to parse JSON");
+        return ESP_FAIL;
+    }
+    if (!cJSON_IsObject(root)) {
+        ESP_LOGE(TAG, "JSON document is not an object");
+        cJSON_Delete(root);
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    weather_info_t parsed = *weather;
+
+    // Observation time, used to align the next fetch with the provider cadence
+    get_time(root, "dt", &parsed.dt);
+
+    const cJSON *conditions = cJSON_GetObjectItemCaseSensitive(root, "weather");
+    if (cJSON_IsArray(conditions)) {
+        const cJSON *first = cJSON_GetArrayItem(conditions, 0);
+        if (cJSON_IsObject(first)) {
+            get_string(first, "description", parsed.description, sizeof(parsed.description));
+            get_string(first, "icon", parsed.icon, sizeof(parsed.icon));
+        }
+    } else if (conditions != NULL) {
+        ESP_LOGW(TAG, "Ignoring \"weather\": not an array");
+    }
+
+    bool has_temperature = false;
+    const cJSON *main = get_object(root, "main");
+    if (main != NULL) {
+        double temperature;
+        if (get_number(main, "temp", -150.0, 150.0, &temperature)) {
+            parsed.temperature = (float)temperature;
+            has_temperature = true;
+        }
+        get_int(main, "pressure", &parsed.pressure);
+        get_int(main, "humidity", &parsed.humidity);
+    }
+
+    const cJSON *sys = get_object(root, "sys");
+    if (sys != NULL) {
+        if (get_time(sys, "sunrise", &parsed.sunrise)) {
+            set_local_time(parsed.sunrise, &parsed.sunrise_hour, &parsed.sunrise_minute);
+        }
+        if (get_time(sys, "sunset", &parsed.sunset)) {
+            set_local_time(parsed.sunset, &parsed.sunset_hour, &parsed.sunset_minute);
+        }
+    }
+
+    cJSON_Delete(root);
+
+    if (!has_temperature) {
+        ESP_LOGE(TAG, "No temperature in weather data");
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    *weather = parsed;
+    return ESP_OK;
+}
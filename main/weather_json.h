@@ -0,0 +1,12 @@
+#ifndef WEATHER_JSON_H
+#define WEATHER_JSON_H
+
+#include "esp_err.h"
+#include "weather.h"
+
+// Fill the model from an OpenWeatherMap "current weather" document. Fields of
+// the wrong type are skipped; a document without a numeric main.temp is
+// rejected. The model is untouched on error.
+esp_err_t weather_parse_json(const char *json, weather_info_t *weather);
+
+#endif // WEATHER_JSON_H
@@ -0,0 +1,199 @@
+#include "widget_runtime.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lauxlib.h"
+#include "lualib.h"
+
+static const char *TAG = "widgets";
+
+// Instructions between budget checks in the count hook
+#define WIDGET_HOOK_INSTRUCTIONS 1000
+
+// Lua allocator enforcing the per-widget heap cap. Returning NULL makes Lua
+// raise a memory error inside the protected call instead of exhausting the heap.
+static void *widget_alloc(void *ud, void *ptr, size_t osize, size_t nsize) {
+    widget_t *widget = ud;
+    size_t old_size = ptr ? osize : 0;
+
+    if (nsize == 0) {
+        free(ptr);
+        widget->stats.mem_used -= old_size;
+        return NULL;
+    }
+
+    if (widget->stats.mem_used - old_size + nsize > WIDGET_MEMORY_LIMIT) {
+        return NULL;
+    }
+
+    void *block = realloc(ptr, nsize);
+    if (block == NULL) {
+        return NULL;
+    }
+
+    widget->stats.mem_used = widget->stats.mem_used - old_size + nsize;
+    if (widget->stats.mem_used > widget->stats.mem_peak) {
+        widget->stats.mem_peak = widget->stats.mem_used;
+    }
+    return block;
+}
+
+static widget_t *widget_from_state(lua_State *L) {
+    return *(widget_t **)lua_getextraspace(L);
+}
+
+static void widget_budget_hook(lua_State *L, lua_Debug *ar) {
+    (void)ar;
+    widget_t *widget = widget_from_state(L);
+    if (esp_timer_get_time() > widget->deadline) {
+        luaL_error(L, "time budget of %lld us exceeded", (long long)widget->budget_us);
+    }
+}
+
+static void open_library(lua_State *L, const char *name, lua_CFunction open) {
+    luaL_requiref(L, name, open, 1);
+    lua_pop(L, 1);
+}
+
+// Protected: only pure libraries, widgets get no io/os access; then the
+// caller's setup, e.g. registering the gfx table
+static int open_sandbox(lua_State *L) {
+    lua_CFunction setup = lua_tocfunction(L, 1);
+    open_library(L, LUA_GNAME, luaopen_base);
+    open_library(L, LUA_STRLIBNAME, luaopen_string);
+    open_library(L, LUA_MATHLIBNAME, luaopen_math);
+    open_library(L, LUA_TABLIBNAME, luaopen_table);
+    if (setup != NULL) {
+        lua_pushcfunction(L, setup);
+        lua_call(L, 0, 0);
+    }
+    return 0;
+}
+
+// Run the function on top of the stack as a protected call under the widget's
+// time budget and account its wall-clock time
+static int widget_call(widget_t *widget, int nargs) {
+    int64_t start = esp_timer_get_time();
+    widget->deadline = start + widget->budget_us;
+    lua_sethook(widget->L, widget_budget_hook, LUA_MASKCOUNT, WIDGET_HOOK_INSTRUCTIONS);
+
+    int status = lua_pcall(widget->L, nargs, 0, 0);
+
+    lua_sethook(widget->L, NULL, 0, 0);
+    widget->stats.wall_us = esp_timer_get_time() - start;
+    if (widget->stats.wall_us > widget->stats.wall_max_us) {
+        widget->stats.wall_max_us = widget->stats.wall_us;
+    }
+
+    if (status != LUA_OK) {
+        widget->stats.errors++;
+        ESP_LOGE(TAG, "Widget %s failed: %s", widget->stats.name, lua_tostring(widget->L, -1));
+        lua_pop(widget->L, 1);
+    } else {
+        widget->stats.errors = 0;
+    }
+    return status;
+}
+
+esp_err_t widget_open(widget_t *widget, const char *name, lua_CFunction setup, uint32_t seed) {
+    memset(widget, 0, sizeof(*widget));
+    snprintf(widget->stats.name, sizeof(widget->stats.name), "%s", name);
+    widget->budget_us = WIDGET_MAX_BUDGET_US;
+
+#if LUA_VERSION_NUM >= 505
+    widget->L = lua_newstate(widget_alloc, widget, seed);
+#else
+    (void)seed;
+    widget->L = lua_newstate(widget_alloc, widget);
+#endif
+    if (widget->L == NULL) {
+        ESP_LOGE(TAG, "Failed to create Lua state for %s", name);
+        return ESP_ERR_NO_MEM;
+    }
+    *(widget_t **)lua_getextraspace(widget->L) = widget;
+
+    lua_pushcfunction(widget->L, open_sandbox);
+    if (setup != NULL) {
+        lua_pushcfunction(widget->L, setup);
+    } else {
+        lua_pushnil(widget->L);
+    }
+    if (lua_pcall(widget->L, 1, 0, 0) != LUA_OK) {
+        ESP_LOGE(TAG, "Failed to set up %s: %s", name, lua_tostring(widget->L, -1));
+        widget_close(widget);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+static int check_draw(lua_State *L) {
+    if (lua_getglobal(L, "draw") != LUA_TFUNCTION) {
+        return luaL_error(L, "no draw() function defined");
+    }
+    return 0;
+}
+
+// Load a chunk, run its top level and make sure it defined draw(). Mode "b"
+// accepts precompiled chunks only; the host tests also load source ("t").
+esp_err_t widget_load(widget_t *widget, const void *chunk, size_t size, const char *mode) {
+    int status = luaL_loadbufferx(widget->L, chunk, size, widget->stats.name, mode);
+    if (status != LUA_OK) {
+        ESP_LOGE(TAG, "Failed to load %s: %s", widget->stats.name, lua_tostring(widget->L, -1));
+        lua_pop(widget->L, 1);
+        return ESP_FAIL;
+    }
+    if (widget_call(widget, 0) != LUA_OK) {
+        return ESP_FAIL;
+    }
+    lua_pushcfunction(widget->L, check_draw);
+    if (widget_call(widget, 0) != LUA_OK) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+typedef struct {
+    widget_push_fn push;
+    void *ctx;
+} draw_call_t;
+
+// Everything that touches the Lua heap, the lookup of draw() and the
+// arguments included, runs in here under lua_pcall
+static int call_draw(lua_State *L) {
+    const draw_call_t *call = lua_touserdata(L, 1);
+    lua_settop(L, 0);
+    if (lua_getglobal(L, "draw") != LUA_TFUNCTION) {
+        return luaL_error(L, "draw is not a function");
+    }
+    int nargs = call->push ? call->push(L, call->ctx) : 0;
+    lua_call(L, nargs, 0);
+    return 0;
+}
+
+// Time budget of later calls, clamped to the WIDGET_*_BUDGET_US bounds
+void widget_set_budget(widget_t *widget, int64_t budget_us) {
+    if (budget_us < WIDGET_MIN_BUDGET_US) {
+        budget_us = WIDGET_MIN_BUDGET_US;
+    } else if (budget_us > WIDGET_MAX_BUDGET_US) {
+        budget_us = WIDGET_MAX_BUDGET_US;
+    }
+    widget->budget_us = budget_us;
+}
+
+// Call draw(...) with the arguments from push; returns the Lua status
+int widget_draw(widget_t *widget, widget_push_fn push, void *ctx) {
+    draw_call_t call = {push, ctx};
+    // Light C function and light userdata: pushing them allocates nothing
+    lua_pushcfunction(widget->L, call_draw);
+    lua_pushlightuserdata(widget->L, &call);
+    return widget_call(widget, 1);
+}
+
+void widget_close(widget_t *widget) {
+    if (widget->L != NULL) {
+        lua_close(widget->L);
+        widget->L = NULL;
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef WIDGET_RUNTIME_H
+#define WIDGET_RUNTIME_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "lua.h"
+#include "widget_stats.h"
+
+// Sandboxed Lua state of one widget: heap cap, time budget per call and
+// statistics. Free of SDL and the asset pack so the limits run on the host.
+//
+// The time budget is wall-clock time from esp_timer, not CPU time: FreeRTOS
+// run-time stats only advance on a context switch, too coarse to stop a
+// draw() within a frame. Time the render task spends preempted counts
+// against the widget.
+#define WIDGET_MEMORY_LIMIT  (48 * 1024)  // Per-widget Lua heap cap in bytes
+#define WIDGET_MIN_BUDGET_US 500          // Per-widget time budget bounds for one draw()
+#define WIDGET_MAX_BUDGET_US 20000
+#define WIDGET_MAX_ERRORS    3            // Consecutive failures before a widget is disabled
+
+typedef struct {
+    lua_State *L;
+    int64_t budget_us;  // Wall-clock budget of one call, WIDGET_MAX_BUDGET_US until set
+    int64_t deadline;
+    widget_stats_t stats;
+} widget_t;
+
+// Pushes the arguments of draw() and returns how many. Runs inside the
+// protected call, so running into the heap cap raises a Lua error instead of
+// reaching the panic handler.
+typedef int (*widget_push_fn)(lua_State *L, void *ctx);
+
+esp_err_t widget_open(widget_t *widget, const char *name, lua_CFunction setup, uint32_t seed);
+esp_err_t widget_load(widget_t *widget, const void *chunk, size_t size, const char *mode);
+void widget_set_budget(widget_t *widget, int64_t budget_us);
+int widget_draw(widget_t *widget, widget_push_fn push, void *ctx);
+void widget_close(widget_t *widget);
+
+#endif // WIDGET_RUNTIME_H
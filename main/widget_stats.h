@@ -0,0 +1,18 @@
+#ifndef WIDGET_STATS_H
+#define WIDGET_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Per-widget statistics, kept apart from widget_runtime.h so users of
+// widgets.h (graphics, host benchmarks) do not need the Lua headers
+typedef struct {
+    char name[32];
+    int64_t wall_us;      // Wall-clock time of the last draw(), including preemption
+    int64_t wall_max_us;
+    size_t mem_used;      // Current Lua heap usage
+    size_t mem_peak;
+    int errors;
+} widget_stats_t;
+
+#endif // WIDGET_STATS_H
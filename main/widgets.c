@@ -0,0 +1,237 @@
+#include "widgets.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_random.h"
+#include "lauxlib.h"
+#include "assetpack.h"
+#include "display_list.h"
+#include "weather.h"
+#include "widget_runtime.h"
+
+static const char *TAG = "widgets";
+
+static widget_t s_widgets[WIDGET_MAX];
+static int s_widget_count = 0;
+static display_list_t s_list;
+static int s_width;
+static int s_height;
+
+static SDL_Color check_color(lua_State *L, int index) {
+    SDL_Color color = {
+        (Uint8)luaL_optinteger(L, index, 0),
+        (Uint8)luaL_optinteger(L, index + 1, 0),
+        (Uint8)luaL_optinteger(L, index + 2, 0),
+        255,
+    };
+    return color;
+}
+
+static SDL_FRect check_rect(lua_State *L) {
+    SDL_FRect rect = {
+        (float)luaL_checknumber(L, 1),
+        (float)luaL_checknumber(L, 2),
+        (float)luaL_checknumber(L, 3),
+        (float)luaL_checknumber(L, 4),
+    };
+    return rect;
+}
+
+// gfx functions record into the display list; nothing is drawn while Lua runs
+
+// gfx.text(x, y, text [, r, g, b]) -> width, height
+static int gfx_text(lua_State *L) {
+    float x = (float)luaL_checknumber(L, 1);
+    float y = (float)luaL_checknumber(L, 2);
+    const char *text = luaL_checkstring(L, 3);
+    SDL_Color color = check_color(L, 4);
+
+    int w, h;
+    if (!display_list_text(&s_list, x, y, text, color, &w, &h)) {
+        return luaL_error(L, "display list full");
+    }
+    lua_pushinteger(L, w);
+    lua_pushinteger(L, h);
+    return 2;
+}
+
+// gfx.rect(x, y, w, h [, r, g, b])
+static int gfx_rect(lua_State *L) {
+    SDL_FRect rect = check_rect(L);
+    if (!display_list_rect(&s_list, DISPLAY_RECT, rect, check_color(L, 5))) {
+        return luaL_error(L, "display list full");
+    }
+    return 0;
+}
+
+// gfx.frame(x, y, w, h [, r, g, b]) - rectangle outline
+static int gfx_frame(lua_State *L) {
+    SDL_FRect rect = check_rect(L);
+    if (!display_list_rect(&s_list, DISPLAY_FRAME, rect, check_color(L, 5))) {
+        return luaL_error(L, "display list full");
+    }
+    return 0;
+}
+
+// gfx.line(x1, y1, x2, y2 [, r, g, b])
+static int gfx_line(lua_State *L) {
+    float x1 = (float)luaL_checknumber(L, 1);
+    float y1 = (float)luaL_checknumber(L, 2);
+    float x2 = (float)luaL_checknumber(L, 3);
+    float y2 = (float)luaL_checknumber(L, 4);
+    if (!display_list_line(&s_list, x1, y1, x2, y2, check_color(L, 5))) {
+        return luaL_error(L, "display list full");
+    }
+    return 0;
+}
+
+// gfx.size() -> width, height of the whole screen, whatever is being drawn
+static int gfx_size(lua_State *L) {
+    lua_pushinteger(L, s_width);
+    lua_pushinteger(L, s_height);
+    return 2;
+}
+
+static const luaL_Reg gfx_functions[] = {
+    {"text", gfx_text},
+    {"rect", gfx_rect},
+    {"frame", gfx_frame},
+    {"line", gfx_line},
+    {"size", gfx_size},
+    {NULL, NULL},
+};
+
+// Protected setup of each state: the gfx table
+static int open_gfx(lua_State *L) {
+    luaL_newlib(L, gfx_functions);
+    lua_setglobal(L, "gfx");
+    return 0;
+}
+
+// Argument of draw(); runs inside the widget's protected call
+static int push_weather(lua_State *L, void *ctx) {
+    (void)ctx;
+    lua_createtable(L, 0, 9);
+    lua_pushstring(L, current_weather.description);
+    lua_setfield(L, -2, "description");
+    lua_pushstring(L, current_weather.icon);
+    lua_setfield(L, -2, "icon");
+    lua_pushnumber(L, current_weather.temperature);
+    lua_setfield(L, -2, "temperature");
+    lua_pushinteger(L, current_weather.pressure);
+    lua_setfield(L, -2, "pressure");
+    lua_pushinteger(L, current_weather.humidity);
+    lua_setfield(L, -2, "humidity");
+    lua_pushinteger(L, (lua_Integer)current_weather.dt);
+    lua_setfield(L, -2, "dt");
+    lua_pushinteger(L, (lua_Integer)current_weather.sunrise);
+    lua_setfield(L, -2, "sunrise");
+    lua_pushinteger(L, (lua_Integer)current_weather.sunset);
+    lua_setfield(L, -2, "sunset");
+    lua_pushinteger(L, (lua_Integer)time(NULL));
+    lua_setfield(L, -2, "now");
+    return 1;
+}
+
+static esp_err_t load_widget(widget_t *widget, const assetpack_entry_t *entry) {
+    esp_err_t err = widget_open(widget, entry->name, open_gfx, esp_random());
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    size_t size = 0;
+    void *owned = NULL;
+    const void *bytecode = assetpack_get(entry->name, &size);
+    if (bytecode == NULL) {
+        bytecode = owned = assetpack_read(entry->name, &size);
+    }
+    if (bytecode == NULL) {
+        ESP_LOGE(TAG, "Failed to load %s: unreadable asset", entry->name);
+        widget_close(widget);
+        return ESP_FAIL;
+    }
+
+    // Mode "b": only precompiled chunks are accepted, nothing is parsed on the device
+    err = widget_load(widget, bytecode, size, "b");
+    free(owned);
+    if (err != ESP_OK) {
+        widget_close(widget);
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Loaded widget %s (%u bytes bytecode, %u bytes heap)",
+             entry->name, (unsigned)size, (unsigned)widget->stats.mem_used);
+    return ESP_OK;
+}
+
+// Load every widget found under "widgets/" in the asset pack and split the
+// widgets' share of a frame interval between them
+int widgets_init(TTF_Font *font, int width, int height, Uint64 frame_ns) {
+    const assetpack_entry_t *first = NULL;
+    int count = assetpack_find_prefix("widgets/", &first);
+
+    display_list_init(&s_list, font);
+    s_width = width;
+    s_height = height;
+    s_widget_count = 0;
+
+    for (int i = 0; i < count && s_widget_count < WIDGET_MAX; i++) {
+        if (load_widget(&s_widgets[s_widget_count], &first[i]) == ESP_OK) {
+            s_widget_count++;
+        }
+    }
+
+    if (s_widget_count > 0) {
+        int64_t share_us = (int64_t)(frame_ns / SDL_NS_PER_US) * WIDGETS_FRAME_SHARE_PERCENT / 100;
+        for (int i = 0; i < s_widget_count; i++) {
+            widget_set_budget(&s_widgets[i], share_us / s_widget_count);
+        }
+        ESP_LOGI(TAG, "%d widget(s) ready, %lld us budget each per update", s_widget_count,
+                 (long long)s_widgets[0].budget_us);
+    } else {
+        ESP_LOGI(TAG, "No widgets loaded");
+    }
+    return s_widget_count;
+}
+
+// Run every widget's draw() once and record its output; caller holds the weather lock
+void widgets_update(void) {
+    display_list_clear(&s_list);
+    for (int i = 0; i < s_widget_count; i++) {
+        widget_t *widget = &s_widgets[i];
+        if (widget->stats.errors >= WIDGET_MAX_ERRORS) {
+            continue;
+        }
+
+        display_list_mark_t mark = display_list_mark(&s_list);
+        if (widget_draw(widget, push_weather, NULL) != LUA_OK) {
+            // Nothing half drawn from a failed draw()
+            display_list_rewind(&s_list, mark);
+            if (widget->stats.errors >= WIDGET_MAX_ERRORS) {
+                ESP_LOGW(TAG, "Disabling widget %s", widget->stats.name);
+            }
+        }
+    }
+}
+
+// Replay the output of the last update; called for every band or layer
+void widgets_draw(SDL_Renderer *renderer) {
+    display_list_draw(&s_list, renderer);
+}
+
+int widgets_get_stats(widget_stats_t *stats, int max) {
+    int count = s_widget_count < max ? s_widget_count : max;
+    for (int i = 0; i < count; i++) {
+        stats[i] = s_widgets[i].stats;
+    }
+    return count;
+}
+
+void widgets_log_stats(void) {
+    for (int i = 0; i < s_widget_count; i++) {
+        const widget_stats_t *stats = &s_widgets[i].stats;
+        ESP_LOGI(TAG, "%s: %lld us wall time per update (max %lld us), heap %u bytes (peak %u)",
+                 stats->name, (long long)stats->wall_us, (long long)stats->wall_max_us,
+                 (unsigned)stats->mem_used, (unsigned)stats->mem_peak);
+    }
+}
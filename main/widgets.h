@@ -0,0 +1,23 @@
+#ifndef WIDGETS_H
+#define WIDGETS_H
+
+#include "SDL3/SDL.h"
+#include "SDL3_ttf/SDL_ttf.h"
+#include "widget_stats.h"
+
+// Lua widgets are precompiled to bytecode at build time and stored in the
+// asset pack under "widgets/". Each defines a global draw(weather); the
+// per-widget heap cap and time budget are in widget_runtime.h. draw() runs
+// once per update and records its gfx calls; every band or layer replays them.
+// With the strip renderer that is every frame, so all widgets together get
+// WIDGETS_FRAME_SHARE_PERCENT of the frame interval, split evenly.
+#define WIDGET_MAX                  8
+#define WIDGETS_FRAME_SHARE_PERCENT 25
+
+int widgets_init(TTF_Font *font, int width, int height, Uint64 frame_ns);
+void widgets_update(void);
+void widgets_draw(SDL_Renderer *renderer);
+int widgets_get_stats(widget_stats_t *stats, int max);
+void widgets_log_stats(void);
+
+#endif // WIDGETS_H
@@ -0,0 +1,152 @@
+// Page transition benchmark at the panel resolution of each board. Runs the
+// device animation engine (anim.c, graphics.c) on the SDL software renderer
+// into an RGB565 surface, like the boards do, with a transition every half
+// second and a weather update every ten. Frames are not paced, so the fps is
+// the sustained rate the engine could deliver; quality is adapted against
+// the 60 Hz budget exactly as on the device. Widgets are not loaded.
+//
+//   anim_bench FONT_FILE [SECONDS_PER_BOARD]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "anim.h"
+#include "weather.h"
+#include "widgets.h"
+
+#define BENCH_FRAME_NS     (SDL_NS_PER_SECOND / 60)  // Virtual clock step: one 60 Hz refresh
+#define BENCH_SWITCH_EVERY 30                         // Frames between page changes
+#define BENCH_UPDATE_EVERY 600                        // Frames between weather updates
+#define BENCH_MAX_FRAMES   100000
+
+typedef struct {
+    const char *board;
+    int width;
+    int height;
+} bench_board_t;
+
+static const bench_board_t s_boards[] = {
+    {"esp-box-3, m5stack_core_s3", 320, 240},
+    {"esp32_p4_function_ev_board", 1024, 600},
+    {"lilygo-ttgo-t5-47 (size only)", 960, 540},
+};
+
+weather_info_t current_weather = {
+    .description = "broken clouds",
+    .icon = "04d",
+    .temperature = 12.3f,
+    .pressure = 1016,
+    .humidity = 71,
+    .dt = 1767261600,
+    .sunrise = 1767250800,
+    .sunset = 1767283200,
+    .sunrise_hour = 7,
+    .sunrise_minute = 40,
+    .sunset_hour = 16,
+    .sunset_minute = 40,
+};
+
+// Widgets come from the asset pack, which the host build does not have
+void widgets_draw(SDL_Renderer *renderer) {
+}
+
+static Uint32 s_frame_us[BENCH_MAX_FRAMES];
+
+static int compare_u32(const void *a, const void *b) {
+    Uint32 x = *(const Uint32 *)a;
+    Uint32 y = *(const Uint32 *)b;
+    return (x > y) - (x < y);
+}
+
+static int run_board(const bench_board_t *board, TTF_Font *font, double seconds) {
+    SDL_Surface *surface = SDL_CreateSurface(board->width, board->height, SDL_PIXELFORMAT_RGB565);
+    SDL_Renderer *renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    if (renderer == NULL) {
+        fprintf(stderr, "%s: no software renderer: %s\n", board->board, SDL_GetError());
+        SDL_DestroySurface(surface);
+        return 1;
+    }
+
+    anim_engine_t anim;
+    anim_init(&anim, renderer, font, board->width, board->height, BENCH_FRAME_NS);
+
+    Uint64 now = 0;
+    Uint64 wall_ns = 0;
+    Uint64 limit_ns = (Uint64)(seconds * SDL_NS_PER_SECOND);
+    anim_quality_t lowest = anim.budget.quality;
+    int page = WEATHER_PAGE_CURRENT;
+    bool detail = false;
+    int frames = 0;
+    int transitions = 0;
+
+    while (wall_ns < limit_ns && frames < BENCH_MAX_FRAMES) {
+        if (frames % BENCH_UPDATE_EVERY == 0) {
+            anim_invalidate(&anim);
+        }
+        if (frames % BENCH_SWITCH_EVERY == 0) {
+            // Alternate slides and detail fades
+            if ((frames / BENCH_SWITCH_EVERY) % 2 == 0) {
+                page = (page + 1) % WEATHER_PAGE_COUNT;
+            } else {
+                detail = !detail;
+            }
+            anim_show(&anim, page, detail, 1, now);
+            transitions += anim_active(&anim);
+        }
+
+        Uint64 start = SDL_GetTicksNS();
+        anim_frame(&anim, now);
+        Uint64 frame_ns = SDL_GetTicksNS() - start;
+
+        s_frame_us[frames++] = (Uint32)(frame_ns / SDL_NS_PER_US);
+        wall_ns += frame_ns;
+        now += BENCH_FRAME_NS;
+        if (anim.budget.quality < lowest) {
+            lowest = anim.budget.quality;
+        }
+    }
+
+    qsort(s_frame_us, frames, sizeof(Uint32), compare_u32);
+    printf("%-30s %4dx%-4d %6d %6d %8.1f %7u %7u %7u %6d %6d\n", board->board, board->width, board->height,
+           frames, transitions, frames / ((double)wall_ns / SDL_NS_PER_SECOND),
+           (unsigned)s_frame_us[frames / 2], (unsigned)s_frame_us[frames * 95 / 100],
+           (unsigned)s_frame_us[frames * 99 / 100], lowest, anim.budget.quality);
+
+    for (int i = 0; i < ANIM_LAYER_COUNT; i++) {
+        SDL_DestroyTexture(anim.layers[i].texture);
+    }
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroySurface(surface);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s FONT_FILE [SECONDS_PER_BOARD]\n", argv[0]);
+        return 2;
+    }
+    double seconds = argc > 2 ? atof(argv[2]) : 2.0;
+
+    if (!SDL_Init(0) || !TTF_Init()) {
+        fprintf(stderr, "SDL init failed: %s\n", SDL_GetError());
+        return 1;
+    }
+    // Same font and size as the device
+    TTF_Font *font = TTF_OpenFont(argv[1], 24);
+    if (font == NULL) {
+        fprintf(stderr, "%s: %s\n", argv[1], SDL_GetError());
+        return 1;
+    }
+
+    printf("%-30s %9s %6s %6s %8s %7s %7s %7s %6s %6s\n", "board", "size", "frames", "trans",
+           "fps", "p50 us", "p95 us", "p99 us", "lowest", "final");
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(s_boards) / sizeof(s_boards[0]); i++) {
+        failures += run_board(&s_boards[i], font, seconds);
+    }
+
+    TTF_CloseFont(font);
+    TTF_Quit();
+    SDL_Quit();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,28 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+
+// Minimal assertions for the host tests: failures are counted, not fatal, so
+// one run reports every broken expectation
+static int check_failures;
+
+#define CHECK(cond) do {                                                      \
+    if (!(cond)) {                                                            \
+        fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+        check_failures++;                                                     \
+    }                                                                         \
+} while (0)
+
+#define CHECK_EQ_INT(actual, expected) do {                                   \
+    long long check_a = (long long)(actual), check_e = (long long)(expected);  \
+    if (check_a != check_e) {                                                 \
+        fprintf(stderr, "%s:%d: CHECK failed: %s == %lld, expected %lld\n",   \
+                __FILE__, __LINE__, #actual, check_a, check_e);               \
+        check_failures++;                                                     \
+    }                                                                         \
+} while (0)
+
+#define CHECK_RESULT() (check_failures == 0 ? (printf("PASS\n"), 0) : (printf("FAIL: %d check(s)\n", check_failures), 1))
+
+#endif // CHECK_H
@@ -0,0 +1,38 @@
+// Host front end for weather_digest_decode(). Reads one record from a file,
+// decodes it with the device code and prints the outcome and every field.
+// Driven by run_digest_fixtures.py with TZ=UTC.
+//
+//   digest_decode RECORD_FILE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "weather_digest.h"
+
+#define RECORD_LIMIT 4096
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s RECORD_FILE\n", argv[0]);
+        return 2;
+    }
+    FILE *file = fopen(argv[1], "rb");
+    if (file == NULL) {
+        perror(argv[1]);
+        return 2;
+    }
+    static uint8_t record[RECORD_LIMIT];
+    size_t len = fread(record, 1, sizeof(record), file);
+    fclose(file);
+    tzset();
+
+    weather_info_t weather = {0};
+    esp_err_t err = weather_digest_decode(record, len, &weather);
+    printf("result=%s bytes=%zu temperature=%.2f pressure=%d humidity=%d dt=%lld sunrise=%lld sunset=%lld "
+           "sunrise_hm=%02d:%02d sunset_hm=%02d:%02d icon=%s description=\"%s\"\n",
+           esp_err_to_name(err), len, weather.temperature, weather.pressure, weather.humidity,
+           (long long)weather.dt, (long long)weather.sunrise, (long long)weather.sunset,
+           weather.sunrise_hour, weather.sunrise_minute, weather.sunset_hour, weather.sunset_minute,
+           weather.icon[0] ? weather.icon : "-", weather.description);
+    return 0;
+}
@@ -0,0 +1,268 @@
+// Host harness for the fetch path. Requests the OpenWeatherMap stand-in
+// (tools/owm_stub_server.py) over a plain socket, feeds the body through the
+// same http_body and weather_json code the device runs and prints one line per
+// request with the outcome, time to last byte and peak heap.
+//
+//   fetch_harness PORT MODE [REQUESTS]
+
+#define _GNU_SOURCE  // memmem
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "cJSON.h"
+#include "http_body.h"
+#include "weather_json.h"
+
+#define RAW_LIMIT  (256 * 1024)
+#define RECV_CHUNK 1023  // MAX_HTTP_RECV_BUFFER on the device: data events are at most this long
+
+static char s_raw[RAW_LIMIT + 1];  // Kept NUL-terminated for the header and chunk scanners
+
+// cJSON allocations are counted through its hooks; the body buffer is added
+// separately, it only grows and stays allocated for the whole parse
+static size_t s_heap_live;
+static size_t s_heap_peak;
+
+static void *counting_malloc(size_t size) {
+    max_align_t *block = malloc(sizeof(max_align_t) + size);
+    if (block == NULL) {
+        return NULL;
+    }
+    *(size_t *)block = size;
+    s_heap_live += size;
+    if (s_heap_live > s_heap_peak) {
+        s_heap_peak = s_heap_live;
+    }
+    return block + 1;
+}
+
+static void counting_free(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    max_align_t *block = (max_align_t *)ptr - 1;
+    s_heap_live -= *(size_t *)block;
+    free(block);
+}
+
+typedef struct {
+    int status;
+    bool complete;       // Framing says the whole body arrived
+    size_t wire_bytes;   // Bytes received, headers included
+    double latency_ms;   // Connect to last byte
+    size_t peak_heap;
+    esp_err_t err;
+} fetch_result_t;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Hand the body over in pieces no longer than the device's receive buffer
+static esp_err_t feed(http_body_t *body, const char *data, size_t len) {
+    while (len > 0) {
+        size_t piece = len < RECV_CHUNK ? len : RECV_CHUNK;
+        esp_err_t err = http_body_append(body, data, piece);
+        if (err != ESP_OK) {
+            return err;
+        }
+        data += piece;
+        len -= piece;
+    }
+    return ESP_OK;
+}
+
+static const char *find_header(const char *headers, const char *end, const char *name) {
+    size_t name_len = strlen(name);
+    for (const char *line = headers; line < end; ) {
+        const char *eol = strstr(line, "\r\n");
+        if (eol == NULL || eol > end) {
+            eol = end;
+        }
+        if ((size_t)(eol - line) > name_len && strncasecmp(line, name, name_len) == 0 && line[name_len] == ':') {
+            const char *value = line + name_len + 1;
+            while (*value == ' ') {
+                value++;
+            }
+            return value;
+        }
+        line = eol + 2;
+    }
+    return NULL;
+}
+
+// Decode a chunked body as far as it goes; complete only with the final empty chunk
+static esp_err_t feed_chunked(http_body_t *body, const char *data, size_t len, bool *complete) {
+    const char *end = data + len;
+    *complete = false;
+    while (data < end) {
+        char *line_end = NULL;
+        unsigned long size = strtoul(data, &line_end, 16);
+        const char *crlf = strstr(data, "\r\n");
+        if (line_end == data || crlf == NULL || crlf >= end) {
+            return ESP_OK;
+        }
+        data = crlf + 2;
+        if (size == 0) {
+            *complete = true;
+            return ESP_OK;
+        }
+        size_t available = (size_t)(end - data);
+        if (available < size) {
+            return feed(body, data, available);
+        }
+        esp_err_t err = feed(body, data, size);
+        if (err != ESP_OK) {
+            return err;
+        }
+        data += size;
+        if (end - data < 2) {
+            return ESP_OK;
+        }
+        data += 2;
+    }
+    return ESP_OK;
+}
+
+static size_t receive_all(int sock) {
+    size_t len = 0;
+    char scratch[RECV_CHUNK];
+    for (;;) {
+        char *dst = len < RAW_LIMIT ? s_raw + len : scratch;
+        size_t room = len < RAW_LIMIT ? RAW_LIMIT - len : sizeof(scratch);
+        ssize_t n = recv(sock, dst, room < RECV_CHUNK ? room : RECV_CHUNK, 0);
+        if (n <= 0) {
+            return len;
+        }
+        len += (size_t)n;
+    }
+}
+
+static void fetch(int port, const char *mode, weather_info_t *weather, fetch_result_t *result) {
+    memset(result, 0, sizeof(*result));
+    result->err = ESP_FAIL;
+
+    double start = now_ms();
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons((uint16_t)port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    struct timeval timeout = {.tv_sec = 10};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    if (sock < 0 || connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror("connect");
+        if (sock >= 0) {
+            close(sock);
+        }
+        return;
+    }
+
+    char request[256];
+    int request_len = snprintf(request, sizeof(request),
+                               "GET /data/2.5/weather?q=Brno,CZ&units=metric&mode=%s HTTP/1.1\r\n"
+                               "Host: localhost:%d\r\nConnection: close\r\n\r\n", mode, port);
+    send(sock, request, (size_t)request_len, 0);
+    size_t raw_len = receive_all(sock);
+    close(sock);
+    result->latency_ms = now_ms() - start;
+    result->wire_bytes = raw_len;
+    if (raw_len > RAW_LIMIT) {
+        raw_len = RAW_LIMIT;
+    }
+    s_raw[raw_len] = '\0';
+
+    char *headers_end = memmem(s_raw, raw_len, "\r\n\r\n", 4);
+    if (headers_end == NULL || sscanf(s_raw, "HTTP/1.%*d %d", &result->status) != 1) {
+        fprintf(stderr, "No HTTP response header\n");
+        return;
+    }
+    *headers_end = '\0';
+    const char *body_start = headers_end + 4;
+    size_t body_len = raw_len - (size_t)(body_start - s_raw);
+
+    http_body_t body;
+    http_body_init(&body, HTTP_BODY_LIMIT);
+    s_heap_live = 0;
+    s_heap_peak = 0;
+
+    esp_err_t err;
+    const char *encoding = find_header(s_raw, headers_end, "Transfer-Encoding");
+    const char *length = find_header(s_raw, headers_end, "Content-Length");
+    if (encoding != NULL && strncasecmp(encoding, "chunked", 7) == 0) {
+        err = feed_chunked(&body, body_start, body_len, &result->complete);
+    } else if (length != NULL) {
+        size_t expected = strtoul(length, NULL, 10);
+        err = feed(&body, body_start, body_len < expected ? body_len : expected);
+        result->complete = body_len >= expected;
+    } else {
+        err = feed(&body, body_start, body_len);
+        result->complete = true;
+    }
+
+    // The device's own checks, then the JSON parser as without the gateway
+    if (err == ESP_OK) {
+        err = http_body_check(&body, result->status, result->complete);
+    }
+    if (err == ESP_OK) {
+        err = weather_parse_json(body.data, weather);
+    }
+    result->err = err;
+
+    result->peak_heap = (body.data ? body.len + 1 : 0) + s_heap_peak;
+    http_body_free(&body);
+}
+
+static const char *outcome(const fetch_result_t *result) {
+    if (result->status == 0) {
+        return "no_response";
+    }
+    if (result->status != 200) {
+        return "http_error";
+    }
+    switch (result->err) {
+        case ESP_OK: return "ok";
+        case ESP_ERR_NO_MEM: return "too_large";
+        case ESP_ERR_INVALID_SIZE: return "truncated";
+        default: return "invalid";
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s PORT MODE [REQUESTS]\n", argv[0]);
+        return 2;
+    }
+    int port = atoi(argv[1]);
+    const char *mode = argv[2];
+    int requests = argc > 3 ? atoi(argv[3]) : 1;
+
+    cJSON_Hooks hooks = {.malloc_fn = counting_malloc, .free_fn = counting_free};
+    cJSON_InitHooks(&hooks);
+    setenv("TZ", "UTC", 1);
+    tzset();
+
+    for (int i = 0; i < requests; i++) {
+        weather_info_t weather = {0};
+        fetch_result_t result;
+        fetch(port, mode, &weather, &result);
+        printf("mode=%s result=%s status=%d bytes=%zu latency_ms=%.1f peak_heap=%zu "
+               "temperature=%.2f pressure=%d humidity=%d dt=%lld icon=%s description=\"%s\"\n",
+               mode, outcome(&result), result.status, result.wire_bytes, result.latency_ms, result.peak_heap,
+               weather.temperature, weather.pressure, weather.humidity, (long long)weather.dt,
+               weather.icon[0] ? weather.icon : "-", weather.description);
+        fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+"""Check gateway encoder and device decoder against recorded upstream responses.
+
+Every JSON document in fixtures/digest (recorded with digest_gateway.py
+--record against owm_stub_server.py; the edge-* files are hand-edited copies
+with a frost temperature and a description longer than the record field) is
+encoded with encode_digest() and decoded by weather_digest_decode() through
+the digest_decode tool. Decoded fields must match the document. Damaged
+records must be rejected with the right error and leave the model untouched.
+Documents weather_json.c rejects for lack of a temperature must not encode,
+and a slow upstream fetch must not hold up cache hits in the gateway.
+
+  run_digest_fixtures.py path/to/digest_decode
+"""
+
+import argparse
+import copy
+import glob
+import json
+import os
+import shlex
+import struct
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+import zlib
+
+ROOT = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+FIXTURES = os.path.join(os.path.dirname(os.path.abspath(__file__)), "fixtures", "digest")
+sys.path.insert(0, os.path.join(ROOT, "tools"))
+
+from digest_gateway import HEADER_FORMAT, HEADER_SIZE, MAGIC, RECORD_SIZE, Upstream, encode_digest  # noqa: E402
+
+
+def decode(tool, record):
+    with tempfile.NamedTemporaryFile(suffix=".bin", delete=False) as f:
+        f.write(record)
+    try:
+        run = subprocess.run([tool, f.name], capture_output=True, text=True, timeout=30,
+                             env=dict(os.environ, TZ="UTC"))
+    finally:
+        os.unlink(f.name)
+    if run.returncode != 0:
+        raise RuntimeError(f"digest_decode exited with {run.returncode}\n{run.stderr}")
+    fields = {}
+    for token in shlex.split(run.stdout):
+        key, _, value = token.partition("=")
+        fields[key] = value
+    return fields
+
+
+def expected_fields(document):
+    """Fields as the device must see them, derived from the document alone."""
+    weather = document["weather"][0]
+    main = document["main"]
+    sunrise = time.gmtime(document["sys"]["sunrise"])
+    sunset = time.gmtime(document["sys"]["sunset"])
+    description = weather["description"].encode("utf-8")
+    if len(description) > 63:
+        # Cut at 63 bytes without leaving half a character behind
+        description = description[:63].decode("utf-8", "ignore").encode("utf-8")
+    return {
+        "result": "ESP_OK",
+        "pressure": str(main["pressure"]),
+        "humidity": str(main["humidity"]),
+        "dt": str(document["dt"]),
+        "sunrise": str(document["sys"]["sunrise"]),
+        "sunset": str(document["sys"]["sunset"]),
+        "sunrise_hm": f"{sunrise.tm_hour:02d}:{sunrise.tm_min:02d}",
+        "sunset_hm": f"{sunset.tm_hour:02d}:{sunset.tm_min:02d}",
+        "icon": weather["icon"],
+        "description": description.decode("utf-8"),
+    }
+
+
+def with_header(record, **changes):
+    """Rewrite header fields, keeping the CRC valid unless crc is given."""
+    magic, version, size, crc = struct.unpack_from(HEADER_FORMAT, record)
+    header = dict(magic=magic, version=version, size=size, crc=crc)
+    header.update(changes)
+    return struct.pack(HEADER_FORMAT, header["magic"], header["version"], header["size"],
+                       header["crc"]) + record[HEADER_SIZE:]
+
+
+def damaged_records(record):
+    """(name, record, expected result) for every way a record can be rejected."""
+    flipped = bytearray(record)
+    flipped[40] ^= 0x01  # humidity
+    # A later revision appending fields: v1 decoders read the prefix, CRC covers all
+    extended = record[HEADER_SIZE:] + b"\x07" * 8
+    extended = with_header(record[:HEADER_SIZE] + extended, size=len(extended) + HEADER_SIZE,
+                           crc=zlib.crc32(extended))
+    return [
+        ("flipped body byte", bytes(flipped), "ESP_ERR_INVALID_CRC"),
+        ("flipped crc", with_header(record, crc=struct.unpack_from("<I", record, 8)[0] ^ 1),
+         "ESP_ERR_INVALID_CRC"),
+        ("truncated body", record[:RECORD_SIZE - 20], "ESP_ERR_INVALID_SIZE"),
+        ("header only", record[:HEADER_SIZE], "ESP_ERR_INVALID_SIZE"),
+        ("size below v1", with_header(record, size=RECORD_SIZE - 1), "ESP_ERR_INVALID_SIZE"),
+        ("size beyond data", with_header(record, size=RECORD_SIZE + 4), "ESP_ERR_INVALID_SIZE"),
+        ("short header", record[:HEADER_SIZE - 1], "ESP_ERR_INVALID_RESPONSE"),
+        ("wrong magic", with_header(record, magic=b"WDGX"), "ESP_ERR_INVALID_RESPONSE"),
+        ("version 2", with_header(record, version=2), "ESP_ERR_INVALID_VERSION"),
+        ("trailing bytes", record + b"\xff" * 16, "ESP_OK"),
+        ("appended fields", extended, "ESP_OK"),
+    ]
+
+
+def without_temperature(document):
+    """(name, document) the device's JSON path rejects for lack of a temperature."""
+    cases = []
+    for name, change in [("no main.temp", lambda main: main.pop("temp")),
+                         ("string main.temp", lambda main: main.update(temp="5")),
+                         ("boolean main.temp", lambda main: main.update(temp=True)),
+                         ("main.temp out of range", lambda main: main.update(temp=151.0))]:
+        changed = copy.deepcopy(document)
+        change(changed["main"])
+        cases.append((name, changed))
+    changed = copy.deepcopy(document)
+    del changed["main"]
+    cases.append(("no main", changed))
+    return cases
+
+
+def check_gateway_lock(document):
+    """A cache hit must be served while another location's fetch is stuck."""
+    started, release = threading.Event(), threading.Event()
+    calls = []
+
+    class SlowUpstream(Upstream):
+        def fetch(self, location):
+            calls.append(location)
+            if location == "slow":
+                started.set()
+                release.wait(10)
+            return document
+
+    upstream = SlowUpstream(argparse.Namespace(replay=None, record=None, interval=600, min_ttl=60))
+    upstream.digest("fast")
+    slow = [threading.Thread(target=upstream.digest, args=("slow",), daemon=True) for _ in range(2)]
+    for thread in slow:
+        thread.start()
+    started.wait(10)
+    hit = threading.Thread(target=upstream.digest, args=("fast",), daemon=True)
+    hit.start()
+    hit.join(2)
+    problems = []
+    if hit.is_alive():
+        problems.append("cache hit waited for another location's upstream fetch")
+    release.set()
+    for thread in slow + [hit]:
+        thread.join(10)
+    if sorted(calls) != ["fast", "slow"]:
+        problems.append(f"upstream calls {calls}, expected one per location")
+    return problems
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        return 2
+    tool = sys.argv[1]
+    paths = sorted(glob.glob(os.path.join(FIXTURES, "*.json")))
+    if not paths:
+        print(f"no fixtures in {FIXTURES}")
+        return 1
+
+    failures = 0
+    for path in paths:
+        with open(path, "rb") as f:
+            document = json.loads(f.read())
+        record = encode_digest(document)
+        name = os.path.basename(path)
+        if len(record) != RECORD_SIZE or record[:4] != MAGIC:
+            print(f"FAIL {name}: encoder produced {len(record)} bytes")
+            failures += 1
+            continue
+
+        fields = decode(tool, record)
+        problems = [f"{key}={fields.get(key)!r}, expected {value!r}"
+                    for key, value in expected_fields(document).items() if fields.get(key) != value]
+        if abs(float(fields["temperature"]) - document["main"]["temp"]) > 0.005:
+            problems.append(f"temperature {fields['temperature']}, expected {document['main']['temp']}")
+        print(f"{name:<40} {fields['result']:<14} {fields['temperature']:>7} {fields['description']!r}")
+
+        for case, damaged, expected in damaged_records(record):
+            result = decode(tool, damaged)
+            if result["result"] != expected:
+                problems.append(f"{case}: {result['result']}, expected {expected}")
+            elif expected != "ESP_OK" and (result["dt"] != "0" or result["description"] != ""):
+                problems.append(f"{case}: model changed on error")
+            elif expected == "ESP_OK" and result["dt"] != fields["dt"]:
+                problems.append(f"{case}: decoded dt {result['dt']}")
+
+        for case, changed in without_temperature(document):
+            try:
+                encode_digest(changed)
+                problems.append(f"{case}: encoded instead of rejected")
+            except ValueError:
+                pass
+
+        for problem in problems:
+            print(f"  FAIL {name}: {problem}")
+        failures += bool(problems)
+
+    for problem in check_gateway_lock(document):
+        print(f"FAIL gateway: {problem}")
+        failures += 1
+
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""Run the fetch harness against tools/owm_stub_server.py in every mode.
+
+Starts the stand-in server on a free local port, runs the harness a few times
+per response mode, checks each outcome and prints latency and peak heap per
+mode. Exits non-zero when any mode behaves differently from what the device
+must do with it.
+
+  run_fetch_harness.py path/to/fetch_harness [--requests N]
+"""
+
+import argparse
+import os
+import shlex
+import socket
+import subprocess
+import sys
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+STUB_SERVER = os.path.join(ROOT, "tools", "owm_stub_server.py")
+
+# Outcome the device must reach for each mode
+EXPECTED = {
+    "normal": "ok",
+    "chunked": "ok",
+    "slow": "ok",
+    "oversized": "too_large",
+    "truncated": "truncated",
+    "malformed": "invalid",
+    "wrongtypes": "ok",
+    "error": "http_error",
+}
+
+
+def free_port():
+    with socket.socket() as sock:
+        sock.bind(("127.0.0.1", 0))
+        return sock.getsockname()[1]
+
+
+def wait_listening(port, timeout=10.0):
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        try:
+            with socket.create_connection(("127.0.0.1", port), timeout=0.5):
+                return
+        except OSError:
+            time.sleep(0.05)
+    raise RuntimeError(f"stub server did not start on port {port}")
+
+
+def parse_line(line):
+    fields = {}
+    for token in shlex.split(line):
+        key, _, value = token.partition("=")
+        fields[key] = value
+    return fields
+
+
+def check_fields(mode, fields):
+    """Field-level checks beyond the outcome; returns a list of problems."""
+    problems = []
+    if fields["result"] != "ok":
+        return problems
+    if abs(float(fields["temperature"]) - 12.34) > 0.01:
+        problems.append(f"temperature {fields['temperature']}")
+    if mode == "wrongtypes":
+        # Every mistyped field must be skipped, leaving the zeroed model alone
+        for key, untouched in (("pressure", "0"), ("humidity", "0"), ("dt", "0"),
+                               ("icon", "-"), ("description", "")):
+            if fields[key] != untouched:
+                problems.append(f"{key}={fields[key]!r} should have been skipped")
+    else:
+        if fields["pressure"] != "1016" or fields["humidity"] != "71":
+            problems.append(f"pressure/humidity {fields['pressure']}/{fields['humidity']}")
+        if fields["description"] != "broken clouds" or fields["icon"] != "04d":
+            problems.append(f"description/icon {fields['description']!r}/{fields['icon']!r}")
+    return problems
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("harness")
+    parser.add_argument("--requests", type=int, default=3)
+    args = parser.parse_args()
+
+    port = free_port()
+    server = subprocess.Popen(
+        [sys.executable, STUB_SERVER, "--host", "127.0.0.1", "--port", str(port), "--drip-ms", "10"],
+        stdout=subprocess.DEVNULL)
+    failures = 0
+    try:
+        wait_listening(port)
+        print(f"{'mode':<11} {'result':<11} {'bytes':>6} {'p50 ms':>8} {'max ms':>8} {'peak heap':>10}")
+        for mode, expected in EXPECTED.items():
+            run = subprocess.run([args.harness, str(port), mode, str(args.requests)],
+                                 capture_output=True, text=True, timeout=120)
+            if run.returncode != 0:
+                print(f"{mode}: harness exited with {run.returncode}\n{run.stderr}")
+                failures += 1
+                continue
+            runs = [parse_line(line) for line in run.stdout.splitlines() if line.startswith("mode=")]
+            if len(runs) != args.requests:
+                print(f"{mode}: expected {args.requests} results, got {len(runs)}")
+                failures += 1
+                continue
+
+            latencies = sorted(float(run["latency_ms"]) for run in runs)
+            peak = max(int(run["peak_heap"]) for run in runs)
+            print(f"{mode:<11} {runs[0]['result']:<11} {runs[0]['bytes']:>6} "
+                  f"{latencies[len(latencies) // 2]:>8.1f} {latencies[-1]:>8.1f} {peak:>10}")
+
+            for run in runs:
+                problems = check_fields(mode, run)
+                if run["result"] != expected:
+                    problems.append(f"result {run['result']}, expected {expected}")
+                for problem in problems:
+                    print(f"  FAIL {mode}: {problem}")
+                failures += bool(problems)
+    finally:
+        server.terminate()
+        server.wait()
+
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,7 @@
+#ifndef ESP_ATTR_H
+#define ESP_ATTR_H
+
+// Host stand-in: RTC memory is ordinary static storage
+#define RTC_NOINIT_ATTR
+
+#endif // ESP_ATTR_H
@@ -0,0 +1,16 @@
+#ifndef ESP_LOG_H
+#define ESP_LOG_H
+
+#include <stdio.h>
+
+// Host stand-in: log lines go to stderr so tool output on stdout stays parseable
+#define ESP_LOG_LINE(level, tag, format, ...) \
+    fprintf(stderr, level " (%s): " format "\n", tag, ##__VA_ARGS__)
+
+#define ESP_LOGE(tag, format, ...) ESP_LOG_LINE("E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) ESP_LOG_LINE("W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ESP_LOG_LINE("I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) do { (void)(tag); } while (0)
+#define ESP_LOGV(tag, format, ...) do { (void)(tag); } while (0)
+
+#endif // ESP_LOG_H
@@ -0,0 +1,30 @@
+#ifndef ESP_ROM_CRC_H
+#define ESP_ROM_CRC_H
+
+#include <stdint.h>
+
+// Host stand-in for the ROM CRC routines: reflected polynomials with the
+// value inverted on the way in and out, as the ROM versions do
+static inline uint32_t esp_rom_crc32_le(uint32_t crc, uint8_t const *buf, uint32_t len) {
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+static inline uint16_t esp_rom_crc16_le(uint16_t crc, uint8_t const *buf, uint32_t len) {
+    crc = (uint16_t)~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (uint16_t)((crc >> 1) ^ (0x8408u & (0u - (crc & 1u))));
+        }
+    }
+    return (uint16_t)~crc;
+}
+
+#endif // ESP_ROM_CRC_H
@@ -0,0 +1,18 @@
+#ifndef ESP_SYSTEM_H
+#define ESP_SYSTEM_H
+
+#include <stdint.h>
+
+// Host stand-in: fixed heap figures
+#define HOST_FREE_HEAP     200000
+#define HOST_MIN_FREE_HEAP 150000
+
+static inline uint32_t esp_get_free_heap_size(void) {
+    return HOST_FREE_HEAP;
+}
+
+static inline uint32_t esp_get_minimum_free_heap_size(void) {
+    return HOST_MIN_FREE_HEAP;
+}
+
+#endif // ESP_SYSTEM_H
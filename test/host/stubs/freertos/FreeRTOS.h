@@ -0,0 +1,11 @@
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+// Host stand-in for the critical section API; the host tests are single threaded
+typedef int portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define taskENTER_CRITICAL(mux) ((void)(mux))
+#define taskEXIT_CRITICAL(mux)  ((void)(mux))
+
+#endif // FREERTOS_H
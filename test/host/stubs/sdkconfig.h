@@ -0,0 +1,7 @@
+#ifndef SDKCONFIG_H
+#define SDKCONFIG_H
+
+// Host stand-in for the generated project configuration: every optional
+// feature (tracing, strip renderer) is off
+
+#endif // SDKCONFIG_H
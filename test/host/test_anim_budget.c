@@ -0,0 +1,129 @@
+// Animation quality controller: overruns lower quality step by step, and
+// after ANIM_RECOVER_NS without one the next frame within budget raises it
+// again, OFF included, up to the board maximum
+#include "anim_budget.h"
+#include "check.h"
+
+#define BUDGET_NS 16666666ull  // 60 Hz panel
+#define GOOD_NS   (BUDGET_NS / 4)
+#define SLOW_NS   (BUDGET_NS * 2)
+#define T0        1000000000ull
+
+// Consecutive frames at the panel rate, advancing the clock
+static void account_frames(anim_budget_t *budget, int count, uint64_t frame_ns, uint64_t *now) {
+    for (int i = 0; i < count; i++) {
+        anim_budget_account(budget, frame_ns, *now);
+        *now += BUDGET_NS;
+    }
+}
+
+static void test_overruns_lower_quality(void) {
+    anim_budget_t budget;
+    anim_budget_init(&budget, BUDGET_NS, ANIM_QUALITY_FULL);
+    CHECK_EQ_INT(budget.quality, ANIM_QUALITY_FULL);
+
+    uint64_t now = T0;
+    account_frames(&budget, 1, SLOW_NS, &now);
+    CHECK_EQ_INT(budget.quality, ANIM_QUALITY_REDUCED);
+    account_frames(&budget, 1, SLOW_NS, &now);
+    CHECK_EQ_INT(budget.quality, ANIM_QUALITY_OFF);
+    account_frames(&budget, 1, SLOW_NS, &now);
+    CHECK_EQ_INT(budget.quality, ANIM_QUALITY_OFF);
+
+    // Exactly on budget is within budget
+    account_frames(&budget, 1, BUDGET_NS, &now);
+    CHECK_EQ_INT(budget.calm_since_ns, T0 + 2 * BUDGET_NS);
+}
+
+static void test_recovers_with_frames(void) {
+    anim_budget_t budget;
+    anim_budget_init(&budget, BUDGET_NS, ANIM_QUALITY_FULL);
+    uint64_t now = T0;
+    account_frames(&budget, 2, SLOW_NS, &now);
+    CHECK_EQ_INT(budget.quality, ANIM_QUALITY_OFF);
+
+    // Continuous frames within budget: one step per ANIM_RECOVER_NS
+    uint64_t overrun = now - BUDGET_NS;
+    while (now < overrun + ANIM_RECOVER_NS) {
+        account_frames(&budget, 1, GOOD_NS, &now);
+        CHECK_EQ_INT(budget.quality, ANIM_QUALITY_OFF);
+    }
+    account_frames(&budget, 1, GOOD_NS, &now);
+    CHECK_EQ_INT(budget.quality, ANIM_QUALITY_REDUCED);
+
+    // One overrun restarts the wait
+    account_frames(&budget, 60, GOOD_NS, &now);
+    account_frames(&budget, 1, SLOW_NS, &now);
+    CHECK_EQ_INT(budget.quality, ANIM_QUALITY_OFF);
+    account_frames(&budget, 100, GOOD_NS, &now);
+    CHECK_EQ_INT(budget.quality, ANIM_QUALITY_OFF);
+}
+
+static void test_recovers_while_idle(void) {
+    // With OFF no transition runs and the loop only presents on input: a
+    // single frame after a quiet period must be enough to bring animations
+    // back, one step per input
+    anim_budget_t budget;
+    anim_budget_init(&budget, BUDGET_NS, ANIM_QUALITY_FULL);
+    anim_budget_account(&budget, SLOW_NS, T0);
+    anim_budget_account(&budget, SLOW_NS, T0 + BUDGET_NS);
+    CHECK_EQ_INT(budget.quality, ANIM_QUALITY_OFF);
+
+    anim_budget_account(&budget, GOOD_NS, T0 + BUDGET_NS + ANIM_RECOVER_NS / 2);
+    CHECK_EQ_INT(budget.quality, ANIM_QUALITY_OFF);
+    anim_budget_account(&budget, GOOD_NS, T0 + BUDGET_NS + ANIM_RECOVER_NS);
+    CHECK_EQ_INT(budget.quality, ANIM_QUALITY_REDUCED);
+    // An overrun after the wait lowers quality instead
+    anim_budget_account(&budget, SLOW_NS, T0 + 10 * ANIM_RECOVER_NS);
+    CHECK_EQ_INT(budget.quality, ANIM_QUALITY_OFF);
+    anim_budget_account(&budget, GOOD_NS, T0 + 12 * ANIM_RECOVER_NS);
+    CHECK_EQ_INT(budget.quality, ANIM_QUALITY_REDUCED);
+    anim_budget_account(&budget, GOOD_NS, T0 + 20 * ANIM_RECOVER_NS);
+    CHECK_EQ_INT(budget.quality, ANIM_QUALITY_FULL);
+
+    // Never above the board maximum
+    anim_budget_account(&budget, GOOD_NS, T0 + 40 * ANIM_RECOVER_NS);
+    CHECK_EQ_INT(budget.quality, ANIM_QUALITY_FULL);
+}
+
+static void test_max_quality_off(void) {
+    // E-paper or no layer cache: stays off however fast the frames are
+    anim_budget_t budget;
+    anim_budget_init(&budget, BUDGET_NS, ANIM_QUALITY_OFF);
+    uint64_t now = T0;
+    account_frames(&budget, 3, GOOD_NS, &now);
+    anim_budget_account(&budget, GOOD_NS, now + 10 * ANIM_RECOVER_NS);
+    CHECK_EQ_INT(budget.quality, ANIM_QUALITY_OFF);
+}
+
+static void test_percentiles(void) {
+    anim_budget_t budget;
+    anim_budget_init(&budget, BUDGET_NS, ANIM_QUALITY_FULL);
+    CHECK_EQ_INT(anim_budget_percentile_us(&budget, 50), 0);
+
+    for (int i = 1; i <= 100; i++) {
+        anim_budget_account(&budget, (uint64_t)i * 1000, T0 + i * BUDGET_NS);
+    }
+    CHECK_EQ_INT(anim_budget_percentile_us(&budget, 50), 51);
+    CHECK_EQ_INT(anim_budget_percentile_us(&budget, 95), 96);
+    CHECK_EQ_INT(anim_budget_percentile_us(&budget, 99), 100);
+    CHECK_EQ_INT(anim_budget_percentile_us(&budget, 100), 100);
+
+    // Only the last ANIM_FRAME_HISTORY frames are kept
+    anim_budget_reset_window(&budget);
+    CHECK_EQ_INT(anim_budget_percentile_us(&budget, 50), 0);
+    uint64_t now = T0;
+    account_frames(&budget, ANIM_FRAME_HISTORY, 9000000, &now);
+    account_frames(&budget, ANIM_FRAME_HISTORY, 1000, &now);
+    CHECK_EQ_INT(anim_budget_percentile_us(&budget, 99), 1);
+    CHECK_EQ_INT(budget.frame_count, 2 * ANIM_FRAME_HISTORY);
+}
+
+int main(void) {
+    test_overruns_lower_quality();
+    test_recovers_with_frames();
+    test_recovers_while_idle();
+    test_max_quality_off();
+    test_percentiles();
+    return CHECK_RESULT();
+}
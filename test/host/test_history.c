@@ -0,0 +1,346 @@
+// History log recovery from torn writes: a log of two segments is written,
+// then damaged the way a power loss during an append or during segment
+// creation leaves it. After every step history_init must cut the log back to
+// the intact samples and history_query must return exactly those, in order.
+// HISTORY_BASE_PATH points at a directory in the build tree.
+
+#include <dirent.h>
+#include <math.h>
+#include <signal.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "check.h"
+#include "history.h"
+
+#define FIRST_TIME    1767261600
+#define INTERVAL      600
+#define TOTAL_SAMPLES (HISTORY_SEGMENT_RECORDS + 10)  // A full segment and part of a second
+#define MAX_SAMPLES   (TOTAL_SAMPLES + 16)
+#define TIME_MAX      ((time_t)INT64_MAX)
+
+static history_sample_t make_sample(int i) {
+    history_sample_t sample = {
+        .time = FIRST_TIME + (time_t)i * INTERVAL,
+        .temperature = -5.0f + (i % 40) * 0.25f,
+        .pressure = 990 + i % 40,
+        .humidity = 30 + i % 60,
+    };
+    return sample;
+}
+
+typedef struct {
+    history_sample_t samples[MAX_SAMPLES];
+    int count;
+    int limit;
+} collect_t;
+
+static bool collect(const history_sample_t *sample, void *ctx) {
+    collect_t *collected = ctx;
+    if (collected->count < MAX_SAMPLES) {
+        collected->samples[collected->count] = *sample;
+    }
+    collected->count++;
+    return collected->limit == 0 || collected->count < collected->limit;
+}
+
+static collect_t s_collected;
+
+static int query(time_t from, time_t to, int limit) {
+    memset(&s_collected, 0, sizeof(s_collected));
+    s_collected.limit = limit;
+    CHECK_EQ_INT(history_query(from, to, collect, &s_collected), ESP_OK);
+    return s_collected.count;
+}
+
+// Collected samples must be make_sample(first), make_sample(first + 1), ...
+static void check_samples(int first, int count) {
+    for (int i = 0; i < count && i < MAX_SAMPLES; i++) {
+        history_sample_t expected = make_sample(first + i);
+        const history_sample_t *sample = &s_collected.samples[i];
+        if (sample->time != expected.time ||
+            lroundf(sample->temperature * 100.0f) != lroundf(expected.temperature * 100.0f) ||
+            sample->pressure != expected.pressure || sample->humidity != expected.humidity) {
+            fprintf(stderr, "sample %d: %lld %.2f %d %d, expected %lld %.2f %d %d\n", first + i,
+                    (long long)sample->time, sample->temperature, sample->pressure, sample->humidity,
+                    (long long)expected.time, expected.temperature, expected.pressure, expected.humidity);
+            check_failures++;
+            return;
+        }
+    }
+}
+
+// The log holds exactly samples 0 .. count - 1, in full and in sub-ranges
+static void check_log(int count) {
+    CHECK_EQ_INT(history_count(), count);
+    CHECK_EQ_INT(query(0, TIME_MAX, 0), count);
+    check_samples(0, count);
+    if (count == 0) {
+        return;
+    }
+
+    // A range across the segment boundary, bounds inclusive
+    int from = HISTORY_SEGMENT_RECORDS - 3;
+    int to = count - 2;
+    if (to >= from) {
+        CHECK_EQ_INT(query(make_sample(from).time, make_sample(to).time, 0), to - from + 1);
+        check_samples(from, to - from + 1);
+    }
+    // Bounds between samples
+    CHECK_EQ_INT(query(make_sample(5).time - 1, make_sample(8).time + 1, 0), 4);
+    check_samples(5, 4);
+    // The visitor stops the stream
+    CHECK_EQ_INT(query(0, TIME_MAX, 3), 3);
+    check_samples(0, 3);
+}
+
+// Simulated reboot: rebuild the index from the files
+static void reopen(void) {
+    CHECK_EQ_INT(history_init(), ESP_OK);
+}
+
+static void append_range(int first, int last) {
+    for (int i = first; i <= last; i++) {
+        history_sample_t sample = make_sample(i);
+        CHECK_EQ_INT(history_append(&sample), ESP_OK);
+    }
+}
+
+static void segment_file(uint32_t sequence, char *path, size_t size) {
+    snprintf(path, size, HISTORY_BASE_PATH "/seg_%08u.bin", (unsigned)sequence);
+}
+
+static long file_size(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long)st.st_size : -1;
+}
+
+static void append_bytes(const char *path, const void *data, size_t size) {
+    FILE *f = fopen(path, "ab");
+    CHECK(f != NULL);
+    if (f != NULL) {
+        CHECK_EQ_INT(fwrite(data, 1, size, f), size);
+        fclose(f);
+    }
+}
+
+static void write_file(const char *path, const void *data, size_t size) {
+    FILE *f = fopen(path, "wb");
+    CHECK(f != NULL);
+    if (f != NULL) {
+        CHECK_EQ_INT(fwrite(data, 1, size, f), size);
+        fclose(f);
+    }
+}
+
+static void read_bytes(const char *path, long offset, void *data, size_t size) {
+    FILE *f = fopen(path, "rb");
+    CHECK(f != NULL);
+    if (f != NULL) {
+        fseek(f, offset, SEEK_SET);
+        CHECK_EQ_INT(fread(data, 1, size, f), size);
+        fclose(f);
+    }
+}
+
+// Segment files left by an earlier run
+static void remove_segments(void) {
+    mkdir(HISTORY_BASE_PATH, 0755);
+    DIR *dir = opendir(HISTORY_BASE_PATH);
+    if (dir == NULL) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] != '.') {
+            char path[512];
+            snprintf(path, sizeof(path), HISTORY_BASE_PATH "/%s", entry->d_name);
+            unlink(path);
+        }
+    }
+    closedir(dir);
+}
+
+static long segment_bytes(int records) {
+    return (long)(sizeof(history_segment_header_t) + records * sizeof(history_record_t));
+}
+
+static void test_write_and_reopen(void) {
+    history_sample_t sample = make_sample(0);
+    CHECK_EQ_INT(history_append(&sample), ESP_ERR_INVALID_STATE);
+
+    reopen();
+    check_log(0);
+
+    append_range(0, TOTAL_SAMPLES - 1);
+    check_log(TOTAL_SAMPLES);
+
+    // Logging the same observation again changes nothing
+    sample = make_sample(TOTAL_SAMPLES - 1);
+    CHECK_EQ_INT(history_append(&sample), ESP_OK);
+    CHECK_EQ_INT(history_count(), TOTAL_SAMPLES);
+
+    reopen();
+    check_log(TOTAL_SAMPLES);
+}
+
+// Power lost while a record was written: only part of it reached flash
+static void test_truncated_record(void) {
+    char path[256];
+    segment_file(1, path, sizeof(path));
+    long size = file_size(path);
+    CHECK_EQ_INT(size, segment_bytes(TOTAL_SAMPLES - HISTORY_SEGMENT_RECORDS));
+    CHECK_EQ_INT(truncate(path, size - 5), 0);
+
+    reopen();
+    check_log(TOTAL_SAMPLES - 1);
+    CHECK_EQ_INT(file_size(path), size - (long)sizeof(history_record_t));
+
+    // The sample that was lost can be logged again
+    append_range(TOTAL_SAMPLES - 1, TOTAL_SAMPLES - 1);
+    check_log(TOTAL_SAMPLES);
+    reopen();
+    check_log(TOTAL_SAMPLES);
+    CHECK_EQ_INT(file_size(path), size);
+}
+
+// Whatever follows the last intact record is cut off
+static void test_trailing_garbage(void) {
+    char path[256];
+    segment_file(1, path, sizeof(path));
+    long size = file_size(path);
+
+    // A few bytes of a record
+    const uint8_t partial[] = {0x12, 0x34, 0x56, 0x78, 0x9A};
+    append_bytes(path, partial, sizeof(partial));
+    reopen();
+    check_log(TOTAL_SAMPLES);
+    CHECK_EQ_INT(file_size(path), size);
+
+    // Whole records of erased flash, with more garbage after them
+    uint8_t erased[3 * sizeof(history_record_t) + 7];
+    memset(erased, 0xFF, sizeof(erased));
+    append_bytes(path, erased, sizeof(erased));
+    reopen();
+    check_log(TOTAL_SAMPLES);
+    CHECK_EQ_INT(file_size(path), size);
+
+    // A record with a good CRC but not newer than its predecessor, as left by
+    // a write of stale data
+    history_record_t last;
+    read_bytes(path, size - (long)sizeof(last), &last, sizeof(last));
+    append_bytes(path, &last, sizeof(last));
+    reopen();
+    check_log(TOTAL_SAMPLES);
+    CHECK_EQ_INT(file_size(path), size);
+
+    // Other files in the directory are not touched
+    char other[256];
+    snprintf(other, sizeof(other), HISTORY_BASE_PATH "/notes.txt");
+    write_file(other, "x", 1);
+    reopen();
+    check_log(TOTAL_SAMPLES);
+    CHECK_EQ_INT(file_size(other), 1);
+}
+
+// Power lost while a segment was created: its header is short, empty or
+// damaged, and the segment is dropped with whatever follows the header
+static void test_torn_segment_header(void) {
+    char path1[256];
+    char path2[256];
+    char path3[256];
+    segment_file(1, path1, sizeof(path1));
+    segment_file(2, path2, sizeof(path2));
+    segment_file(3, path3, sizeof(path3));
+
+    history_segment_header_t header;
+    read_bytes(path1, 0, &header, sizeof(header));
+
+    // Half a header, and a file created but never written
+    write_file(path2, &header, sizeof(header) / 2);
+    write_file(path3, "", 0);
+    reopen();
+    check_log(TOTAL_SAMPLES);
+    CHECK_EQ_INT(file_size(path2), -1);
+    CHECK_EQ_INT(file_size(path3), -1);
+
+    // A whole header that fails its CRC, followed by a record
+    history_segment_header_t damaged = header;
+    damaged.sequence = 2;
+    damaged.base_time = make_sample(TOTAL_SAMPLES).time;  // CRC still that of segment 1
+    history_record_t record;
+    read_bytes(path1, segment_bytes(0), &record, sizeof(record));
+    write_file(path2, &damaged, sizeof(damaged));
+    append_bytes(path2, &record, sizeof(record));
+    reopen();
+    check_log(TOTAL_SAMPLES);
+    CHECK_EQ_INT(file_size(path2), -1);
+
+    // Logging goes on in the segment that survived
+    append_range(TOTAL_SAMPLES, TOTAL_SAMPLES);
+    reopen();
+    check_log(TOTAL_SAMPLES + 1);
+    CHECK_EQ_INT(file_size(path1), segment_bytes(TOTAL_SAMPLES + 1 - HISTORY_SEGMENT_RECORDS));
+}
+
+// A write that fails partway, here on the file size limit, leaves nothing
+// behind, and later appends land right after the last intact record
+static void test_failed_append(void) {
+    int count = TOTAL_SAMPLES + 1;
+    char path[256];
+    segment_file(1, path, sizeof(path));
+    long size = file_size(path);
+
+    struct rlimit unlimited;
+    CHECK_EQ_INT(getrlimit(RLIMIT_FSIZE, &unlimited), 0);
+    struct rlimit limit = unlimited;
+    limit.rlim_cur = (rlim_t)size + 5;
+    signal(SIGXFSZ, SIG_IGN);
+    CHECK_EQ_INT(setrlimit(RLIMIT_FSIZE, &limit), 0);
+    history_sample_t sample = make_sample(count);
+    CHECK_EQ_INT(history_append(&sample), ESP_FAIL);
+    CHECK_EQ_INT(setrlimit(RLIMIT_FSIZE, &unlimited), 0);
+    CHECK_EQ_INT(file_size(path), size);
+    check_log(count);
+
+    // Bytes of a failed write that could not be cut off are written over
+    // within the same session, not logged after
+    const uint8_t partial[] = {0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE};
+    append_bytes(path, partial, sizeof(partial));
+    append_range(count, count + 1);
+    check_log(count + 2);
+    reopen();
+    check_log(count + 2);
+    CHECK_EQ_INT(file_size(path), size + 2 * (long)sizeof(history_record_t));
+}
+
+static bool append_while_visiting(const history_sample_t *sample, void *ctx) {
+    int *next = ctx;
+    history_sample_t appended = make_sample((*next)++);
+    CHECK_EQ_INT(history_append(&appended), ESP_OK);
+    return true;
+}
+
+// The visitor runs without the lock held: appending from it must not block.
+// More samples than one query chunk are visited.
+static void test_append_from_visitor(void) {
+    int count = TOTAL_SAMPLES + 3;
+    int next = count;
+    CHECK_EQ_INT(history_query(make_sample(10).time, make_sample(49).time, append_while_visiting, &next), ESP_OK);
+    CHECK_EQ_INT(next, count + 40);
+    check_log(count + 40);
+}
+
+int main(void) {
+    remove_segments();
+    test_write_and_reopen();
+    test_truncated_record();
+    test_trailing_garbage();
+    test_torn_segment_header();
+    test_failed_append();
+    test_append_from_visitor();
+    remove_segments();
+    return CHECK_RESULT();
+}
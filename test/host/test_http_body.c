@@ -0,0 +1,47 @@
+// Response body accumulation: growth across data events and the size limit,
+// and the checks that decide whether a response goes to the parser
+#include <string.h>
+#include "check.h"
+#include "http_body.h"
+
+int main(void) {
+    http_body_t body;
+
+    http_body_init(&body, 16);
+    CHECK(body.data == NULL);
+    CHECK_EQ_INT(http_body_append(&body, "{\"temp\":", 8), ESP_OK);
+    CHECK_EQ_INT(http_body_append(&body, "12}", 3), ESP_OK);
+    CHECK_EQ_INT(body.len, 11);
+    CHECK(strcmp(body.data, "{\"temp\":12}") == 0);
+    CHECK(!body.overflow);
+
+    // Exactly at the limit is still accepted
+    CHECK_EQ_INT(http_body_append(&body, "     ", 5), ESP_OK);
+    CHECK_EQ_INT(body.len, 16);
+    CHECK(!body.overflow);
+
+    // One byte more discards the rest of the response, including later events
+    CHECK_EQ_INT(http_body_append(&body, "x", 1), ESP_OK);
+    CHECK(body.overflow);
+    CHECK_EQ_INT(http_body_append(&body, "", 0), ESP_OK);
+    CHECK_EQ_INT(body.len, 16);
+    CHECK_EQ_INT(body.data[16], '\0');
+
+    http_body_free(&body);
+    CHECK(body.data == NULL);
+    CHECK_EQ_INT(body.len, 0);
+
+    // Status first, then size, then completeness
+    http_body_init(&body, 16);
+    CHECK_EQ_INT(http_body_check(&body, 200, true), ESP_FAIL);
+    http_body_append(&body, "{}", 2);
+    CHECK_EQ_INT(http_body_check(&body, 200, true), ESP_OK);
+    CHECK_EQ_INT(http_body_check(&body, 404, true), ESP_FAIL);
+    CHECK_EQ_INT(http_body_check(&body, 200, false), ESP_ERR_INVALID_SIZE);
+    http_body_append(&body, "01234567890123456789", 20);
+    CHECK_EQ_INT(http_body_check(&body, 200, false), ESP_ERR_NO_MEM);
+    CHECK_EQ_INT(http_body_check(&body, 500, false), ESP_FAIL);
+    http_body_free(&body);
+
+    return CHECK_RESULT();
+}
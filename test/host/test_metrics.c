@@ -0,0 +1,172 @@
+// Metrics store: log2 bucket boundaries, the cumulative Prometheus histogram
+// output, and the RTC store surviving a reboot only while its CRC matches.
+// metrics.c is included to reach the store and damage it between "boots".
+
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+#include "metrics.c"
+
+static char *s_dump;
+
+// Prometheus text of the current store
+static const char *dump(void) {
+    free(s_dump);
+    size_t size = 0;
+    FILE *out = open_memstream(&s_dump, &size);
+    metrics_dump_prometheus(out);
+    fclose(out);
+    return s_dump;
+}
+
+static void check_line(const char *line) {
+    const char *text = dump();
+    size_t len = strlen(line);
+    for (const char *at = strstr(text, line); at != NULL; at = strstr(at + 1, line)) {
+        if ((at == text || at[-1] == '\n') && at[len] == '\n') {
+            return;
+        }
+    }
+    fprintf(stderr, "missing line: %s\n", line);
+    check_failures++;
+}
+
+static void test_bucket_boundaries(void) {
+    const histogram_t *h = &s_metrics.histograms[METRIC_FETCH];
+
+    // Bucket k holds samples <= 2^k us; negative durations count as 0
+    const struct {
+        int64_t us;
+        int bucket;
+    } cases[] = {
+        {0, 0}, {1, 0}, {-5, 0}, {2, 1}, {3, 2}, {4, 2}, {5, 3}, {1024, 10}, {1025, 11},
+        {INT64_C(1) << (METRICS_BUCKETS - 1), METRICS_BUCKETS - 1},
+        {(INT64_C(1) << (METRICS_BUCKETS - 1)) + 1, METRICS_BUCKETS},  // Overflow, +Inf only
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        metrics_init();
+        memset(&s_metrics.histograms, 0, sizeof(s_metrics.histograms));
+        metrics_observe(METRIC_FETCH, cases[i].us);
+        int found = -1;
+        for (int bucket = 0; bucket < METRICS_BUCKETS; bucket++) {
+            if (h->buckets[bucket] != 0) {
+                found = bucket;
+            }
+        }
+        if (h->overflow != 0) {
+            found = METRICS_BUCKETS;
+        }
+        if (found != cases[i].bucket) {
+            fprintf(stderr, "%lld us landed in bucket %d, expected %d\n", (long long)cases[i].us, found,
+                    cases[i].bucket);
+            check_failures++;
+        }
+        CHECK_EQ_INT(h->count, 1);
+    }
+}
+
+static void test_prometheus_histogram(void) {
+    memset(&s_metrics, 0, sizeof(s_metrics));
+    metrics_init();
+    const int64_t samples[] = {0, 1, -5, 2, 3, 4, INT64_C(1) << 25, (INT64_C(1) << 25) + 1};
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        metrics_observe(METRIC_FETCH, samples[i]);
+    }
+
+    // Cumulative counts; the overflow sample only shows in +Inf
+    check_line("# TYPE weather_fetch_latency_seconds histogram");
+    check_line("weather_fetch_latency_seconds_bucket{le=\"1e-06\"} 3");
+    check_line("weather_fetch_latency_seconds_bucket{le=\"2e-06\"} 4");
+    check_line("weather_fetch_latency_seconds_bucket{le=\"4e-06\"} 6");
+    check_line("weather_fetch_latency_seconds_bucket{le=\"16.7772\"} 6");
+    check_line("weather_fetch_latency_seconds_bucket{le=\"33.5544\"} 7");
+    check_line("weather_fetch_latency_seconds_bucket{le=\"+Inf\"} 8");
+    check_line("weather_fetch_latency_seconds_sum 67.108875");
+    check_line("weather_fetch_latency_seconds_count 8");
+
+    // Every histogram: one line per bucket plus +Inf, never decreasing
+    const char *names[] = {"weather_fetch_latency_seconds", "weather_wifi_connect_seconds",
+                           "weather_parse_seconds", "weather_render_seconds"};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        char prefix[64];
+        snprintf(prefix, sizeof(prefix), "%s_bucket{le=\"", names[i]);
+        int lines = 0;
+        unsigned long long previous = 0;
+        for (const char *at = strstr(dump(), prefix); at != NULL; at = strstr(at + 1, prefix)) {
+            unsigned long long value = strtoull(strstr(at, "} ") + 2, NULL, 10);
+            CHECK(value >= previous);
+            previous = value;
+            lines++;
+        }
+        CHECK_EQ_INT(lines, METRICS_BUCKETS + 1);
+    }
+    check_line("weather_render_seconds_bucket{le=\"+Inf\"} 0");
+    check_line("weather_render_seconds_count 0");
+}
+
+static void test_counters(void) {
+    memset(&s_metrics, 0, sizeof(s_metrics));
+    metrics_init();
+    metrics_count(METRIC_WIFI_RETRIES);
+    metrics_count(METRIC_WIFI_RETRIES);
+    metrics_count(METRIC_PARSE_FAILURES);
+    metrics_http_status(200);
+    metrics_http_status(204);
+    metrics_http_status(404);
+    metrics_http_status(99);
+    metrics_http_status(600);
+
+    check_line("weather_wifi_retries_total 2");
+    check_line("weather_wifi_failures_total 0");
+    check_line("weather_parse_failures_total 1");
+    check_line("weather_http_responses_total{class=\"2xx\"} 2");
+    check_line("weather_http_responses_total{class=\"4xx\"} 1");
+    check_line("weather_http_responses_total{class=\"other\"} 2");
+    check_line("weather_heap_low_water_bytes 150000");
+    check_line("weather_boots_total 1");
+}
+
+// Reboots keep an intact store and start over from a damaged one
+static void test_store_survives_only_intact(void) {
+    memset(&s_metrics, 0, sizeof(s_metrics));
+    metrics_init();
+    metrics_count(METRIC_HTTP_ERRORS);
+    metrics_observe(METRIC_PARSE, 100);
+
+    metrics_init();
+    check_line("weather_boots_total 2");
+    check_line("weather_http_transport_errors_total 1");
+    check_line("weather_parse_seconds_count 1");
+
+    // One counter bit flipped, magic and version intact
+    s_metrics.counters[METRIC_HTTP_ERRORS] ^= 0x100;
+    metrics_init();
+    check_line("weather_boots_total 1");
+    check_line("weather_http_transport_errors_total 0");
+    check_line("weather_parse_seconds_count 0");
+
+    // Damage to a histogram sum, which is never printed as a count
+    metrics_observe(METRIC_RENDER, 5000);
+    metrics_init();
+    check_line("weather_boots_total 2");
+    s_metrics.histograms[METRIC_RENDER].sum_us += 1;
+    metrics_init();
+    check_line("weather_boots_total 1");
+    check_line("weather_render_seconds_count 0");
+
+    // Another layout version
+    s_metrics.version = METRICS_VERSION + 1;
+    s_metrics.crc = store_crc(&s_metrics);
+    metrics_init();
+    CHECK_EQ_INT(s_metrics.version, METRICS_VERSION);
+    check_line("weather_boots_total 1");
+}
+
+int main(void) {
+    test_bucket_boundaries();
+    test_prometheus_histogram();
+    test_counters();
+    test_store_survives_only_intact();
+    free(s_dump);
+    return CHECK_RESULT();
+}
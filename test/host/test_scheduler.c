@@ -0,0 +1,151 @@
+// Refresh planning against a virtual clock: provider alignment, the fallback
+// without a valid clock, the daily budget and failure backoff
+#include "check.h"
+#include "scheduler.h"
+
+#define DAY 86400
+// 2026-01-01 00:00:00 UTC, a day boundary
+#define T0 ((time_t)1767225600)
+
+static scheduler_t make_scheduler(time_t now, int daily_budget) {
+    scheduler_config_t config = SCHEDULER_CONFIG_DEFAULT();
+    config.daily_budget = daily_budget;
+    scheduler_t s;
+    scheduler_init(&s, &config, now, 12345);
+    return s;
+}
+
+static void test_aligns_to_provider(void) {
+    scheduler_t s = make_scheduler(T0, 288);
+    time_t now = T0 + 3 * 3600 + 125;
+    time_t dt = now - 125;  // Observation published two minutes ago
+
+    scheduler_on_success(&s, now, dt, true);
+    time_t next = scheduler_next_fetch(&s);
+    // update_interval + update_margin after dt, plus at most margin/2 jitter
+    CHECK(next >= dt + 600 + 60);
+    CHECK(next <= dt + 600 + 60 + 30);
+
+    // Provider has not refreshed: re-poll soon instead of a full interval later.
+    // With 288 calls a day the minimum gap of 300 s outweighs poll_step.
+    now = next;
+    scheduler_on_success(&s, now, dt, true);
+    next = scheduler_next_fetch(&s);
+    CHECK(next >= now + 300);
+    CHECK(next <= now + 300 + 30);
+}
+
+static void test_plain_interval_without_clock(void) {
+    // Before SNTP or the Date header, the RTC counts from the epoch
+    time_t boot_clock = 42;
+    scheduler_t s = make_scheduler(boot_clock, 288);
+    time_t dt = T0 + 7200;
+
+    scheduler_on_success(&s, boot_clock, dt, false);
+    time_t next = scheduler_next_fetch(&s);
+    // dt is decades ahead of this clock; aligning to it would never fetch again
+    CHECK(next >= boot_clock + 600);
+    CHECK(next <= boot_clock + 600 + 30);
+
+    // A repeated observation is still not a reason to poll faster without a clock
+    scheduler_on_success(&s, next, dt, false);
+    CHECK(scheduler_next_fetch(&s) >= next + 600);
+}
+
+static void test_budget_charged_per_request(void) {
+    scheduler_t s = make_scheduler(T0, 3);
+    time_t now = T0 + 600;
+
+    // Windows that never sent a request (no Wi-Fi, DNS failure) cost nothing
+    for (int i = 0; i < 10; i++) {
+        CHECK(scheduler_budget_available(&s, now));
+        scheduler_on_failure(&s, now);
+    }
+    CHECK_EQ_INT(s.calls_today, 0);
+
+    for (int i = 0; i < 3; i++) {
+        CHECK(scheduler_budget_available(&s, now));
+        scheduler_count_call(&s, now);
+    }
+    CHECK_EQ_INT(s.calls_today, 3);
+
+    // Spent: the schedule moves to the next UTC day
+    CHECK(!scheduler_budget_available(&s, now));
+    time_t next = scheduler_next_fetch(&s);
+    CHECK(next >= T0 + DAY);
+    CHECK(next <= T0 + DAY + 60);
+
+    // A new day brings a fresh budget
+    CHECK(scheduler_budget_available(&s, next));
+    scheduler_count_call(&s, next);
+    CHECK_EQ_INT(s.calls_today, 1);
+}
+
+static void test_backoff(void) {
+    scheduler_t s = make_scheduler(T0, 288);
+    time_t now = T0;
+    int expected = 15;
+
+    for (int i = 0; i < 12; i++) {
+        scheduler_on_failure(&s, now);
+        time_t delay = scheduler_next_fetch(&s) - now;
+        // Equal jitter: between half and all of the exponential delay
+        CHECK(delay >= expected / 2);
+        CHECK(delay <= expected);
+        expected = expected * 2 > 1800 ? 1800 : expected * 2;
+    }
+
+    // One success resets the backoff
+    scheduler_on_success(&s, now, now - 30, true);
+    scheduler_on_failure(&s, now);
+    CHECK(scheduler_next_fetch(&s) - now <= 15);
+}
+
+// Run one virtual day against a provider publishing every 10 minutes with a
+// random delay and check the call count and the age of what is on screen
+static void test_virtual_day(void) {
+    scheduler_t s = make_scheduler(T0, 288);
+    uint32_t rng = 99;
+    time_t now = T0;
+    time_t worst_age = 0;
+    int calls = 0;
+
+    while (now < T0 + DAY) {
+        time_t next = scheduler_next_fetch(&s);
+        if (next > now) {
+            now = next;
+            continue;
+        }
+        CHECK(scheduler_budget_available(&s, now));
+        scheduler_count_call(&s, now);
+        calls++;
+
+        // The observation for a slot is published 30..150 s after the slot starts
+        rng = rng * 1103515245u + 12345u;
+        time_t slot = now - (now - T0) % 600;
+        time_t published = slot + 30 + (time_t)(rng >> 16) % 121;
+        time_t dt = now >= published ? slot : slot - 600;
+
+        // Oldest data on screen: just before this fetch replaced the previous one
+        if (calls > 1 && now - s.last_data_dt > worst_age) {
+            worst_age = now - s.last_data_dt;
+        }
+        scheduler_on_success(&s, now, dt, true);
+        CHECK(scheduler_next_fetch(&s) > now);
+    }
+
+    printf("virtual day: %d calls, data at most %lld s old\n", calls, (long long)worst_age);
+    CHECK(calls <= 288);
+    CHECK(calls >= 144);
+    // A late observation costs at most one re-poll: never two updates behind
+    CHECK(worst_age < 2 * 600);
+}
+
+int main(void) {
+    test_aligns_to_provider();
+    test_plain_interval_without_clock();
+    test_budget_charged_per_request();
+    test_backoff();
+    test_virtual_day();
+    return CHECK_RESULT();
+}
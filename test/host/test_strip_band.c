@@ -0,0 +1,177 @@
+// Strip renderer against whole-frame rendering: the same scene (built-in
+// pages plus a recorded widget display list with text, rectangles and lines
+// crossing band edges) drawn in one go and band by band must give the same
+// RGB565 pixels. Also prints the frame rate of both ways of drawing.
+//
+//   test_strip_band FONT_FILE
+
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+#include "display_list.h"
+#include "graphics.h"
+#include "strip_band.h"
+#include "weather.h"
+#include "widgets.h"
+
+#define WIDTH       320  // ESP32-S3-BOX and M5Stack CoreS3, the strip renderer boards
+#define HEIGHT      240
+#define BENCH_FRAMES 50
+
+weather_info_t current_weather = {
+    .description = "broken clouds",
+    .icon = "04d",
+    .temperature = -3.5f,
+    .pressure = 1016,
+    .humidity = 71,
+    .dt = 1767261600,
+    .sunrise = 1767250800,
+    .sunset = 1767283200,
+    .sunrise_hour = 7,
+    .sunrise_minute = 40,
+    .sunset_hour = 16,
+    .sunset_minute = 40,
+};
+
+// Stands in for the Lua widgets: recorded once, replayed by every band
+static display_list_t s_list;
+
+void widgets_draw(SDL_Renderer *renderer) {
+    display_list_draw(&s_list, renderer);
+}
+
+static void record_widgets(TTF_Font *font) {
+    SDL_Color red = {200, 30, 30, 255};
+    SDL_Color blue = {20, 40, 220, 255};
+    int w, h;
+    display_list_init(&s_list, font);
+    CHECK(display_list_rect(&s_list, DISPLAY_RECT, (SDL_FRect){200.0f, 10.0f, 100.0f, 50.0f}, blue));
+    CHECK(display_list_text(&s_list, 205.0f, 17.0f, "12.3°C", red, &w, &h));
+    CHECK(w > 0 && h > 0);
+    CHECK(display_list_rect(&s_list, DISPLAY_FRAME, (SDL_FRect){198.5f, 8.5f, 104.0f, 55.0f}, red));
+    // Steep, shallow and fractional lines across several band edges
+    CHECK(display_list_line(&s_list, 10.0f, 5.0f, 300.0f, 230.0f, red));
+    CHECK(display_list_line(&s_list, 310.0f, 47.0f, 12.0f, 49.0f, blue));
+    CHECK(display_list_line(&s_list, 150.3f, 0.0f, 151.7f, 239.0f, blue));
+    CHECK(display_list_text(&s_list, 30.0f, 190.0f, "Wind 3.6 m/s", blue, &w, &h));
+}
+
+typedef struct {
+    TTF_Font *font;
+    int page;
+    bool detail;
+} scene_t;
+
+static void draw_scene(SDL_Renderer *renderer, void *ctx) {
+    const scene_t *scene = ctx;
+    draw_weather_page(renderer, scene->font, scene->page, scene->detail);
+}
+
+// Whole frame into one full-screen surface, copied out as packed rows
+static void render_full(SDL_Renderer *renderer, SDL_Surface *surface, const scene_t *scene, uint16_t *out) {
+    draw_scene(renderer, (void *)scene);
+    SDL_FlushRenderer(renderer);
+    for (int y = 0; y < HEIGHT; y++) {
+        memcpy(out + y * WIDTH, (const uint8_t *)surface->pixels + y * surface->pitch, WIDTH * sizeof(uint16_t));
+    }
+}
+
+// Band by band through strip_band.c, as strip.c does before the byte swap
+static void render_banded(strip_band_t *band, uint16_t *buffer, const scene_t *scene, uint16_t *out) {
+    for (int y = 0; y < HEIGHT; y += band->rows) {
+        int rows = SDL_min(band->rows, HEIGHT - y);
+        strip_band_draw(band, buffer, y, draw_scene, (void *)scene);
+        memcpy(out + y * WIDTH, buffer, (size_t)rows * WIDTH * sizeof(uint16_t));
+    }
+}
+
+static void compare(const char *name, int rows, const uint16_t *full, const uint16_t *banded) {
+    for (int i = 0; i < WIDTH * HEIGHT; i++) {
+        if (full[i] != banded[i]) {
+            fprintf(stderr, "%s, %d-row bands: first difference at %d,%d: %04x vs %04x\n",
+                    name, rows, i % WIDTH, i / WIDTH, full[i], banded[i]);
+            check_failures++;
+            return;
+        }
+    }
+}
+
+static double fps(Uint64 start_ns, int frames) {
+    return frames / ((double)(SDL_GetTicksNS() - start_ns) / SDL_NS_PER_SECOND);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s FONT_FILE\n", argv[0]);
+        return 2;
+    }
+    if (!SDL_Init(0) || !TTF_Init()) {
+        fprintf(stderr, "SDL init failed: %s\n", SDL_GetError());
+        return 1;
+    }
+    TTF_Font *font = TTF_OpenFont(argv[1], 24);
+    if (font == NULL) {
+        fprintf(stderr, "%s: %s\n", argv[1], SDL_GetError());
+        return 1;
+    }
+    // The whole-frame renderer gets the line method the band renderer sets
+    SDL_SetHint(SDL_HINT_RENDER_LINE_METHOD, "1");
+    record_widgets(font);
+
+    SDL_Surface *surface = SDL_CreateSurface(WIDTH, HEIGHT, SDL_PIXELFORMAT_RGB565);
+    SDL_Renderer *renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    if (renderer == NULL) {
+        fprintf(stderr, "No software renderer: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    static uint16_t full[WIDTH * HEIGHT];
+    static uint16_t banded[WIDTH * HEIGHT];
+    static uint16_t buffer[WIDTH * HEIGHT];
+    const scene_t scenes[] = {
+        {font, WEATHER_PAGE_CURRENT, false},
+        {font, WEATHER_PAGE_CURRENT, true},
+        {font, WEATHER_PAGE_SUN, false},  // The detail view depends on the wall clock
+    };
+    // Default band height, an odd one that does not divide the screen, one band
+    const int band_rows[] = {24, 7, HEIGHT};
+
+    for (size_t s = 0; s < sizeof(scenes) / sizeof(scenes[0]); s++) {
+        char name[32];
+        snprintf(name, sizeof(name), "page %d detail %d", scenes[s].page, scenes[s].detail);
+        render_full(renderer, surface, &scenes[s], full);
+        for (size_t r = 0; r < sizeof(band_rows) / sizeof(band_rows[0]); r++) {
+            strip_band_t band;
+            CHECK(strip_band_init(&band, WIDTH, HEIGHT, band_rows[r], buffer));
+            memset(banded, 0xA5, sizeof(banded));
+            render_banded(&band, buffer, &scenes[s], banded);
+            compare(name, band_rows[r], full, banded);
+            strip_band_deinit(&band);
+        }
+    }
+
+    Uint64 start = SDL_GetTicksNS();
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        render_full(renderer, surface, &scenes[0], full);
+    }
+    double full_fps = fps(start, BENCH_FRAMES);
+
+    strip_band_t band;
+    CHECK(strip_band_init(&band, WIDTH, HEIGHT, 24, buffer));
+    start = SDL_GetTicksNS();
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        render_banded(&band, buffer, &scenes[0], banded);
+    }
+    double banded_fps = fps(start, BENCH_FRAMES);
+    strip_band_deinit(&band);
+
+    printf("%dx%d: whole frame %.1f fps, 24-row bands %.1f fps (drawing only, no panel transfer)\n",
+           WIDTH, HEIGHT, full_fps, banded_fps);
+
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroySurface(surface);
+    TTF_CloseFont(font);
+    TTF_Quit();
+    SDL_Quit();
+    return CHECK_RESULT();
+}
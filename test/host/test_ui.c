@@ -0,0 +1,248 @@
+// UI event pipeline driven by synthetic SDL events, the way the main loop
+// drives it: finger, mouse and weather events go through the SDL queue into
+// ui_handle_event, and frames are paced and reported with
+// ui_frame_timeout_ms and ui_frame_presented on a virtual clock.
+
+#include "check.h"
+#include "graphics.h"
+#include "ui.h"
+
+#define WIDTH    320
+#define HEIGHT   240
+#define T0       (10 * SDL_NS_PER_SECOND)  // Virtual clock start; event timestamps must not be 0
+#define MS(n)    ((Uint64)(n) * SDL_NS_PER_MS)
+
+static void push_finger(Uint32 type, float x, float y, Uint64 timestamp) {
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = type;
+    event.common.timestamp = timestamp;
+    event.tfinger.touchID = 1;
+    event.tfinger.fingerID = 1;
+    event.tfinger.x = x / WIDTH;
+    event.tfinger.y = y / HEIGHT;
+    CHECK(SDL_PushEvent(&event));
+}
+
+static void push_click(SDL_MouseID which, float x, float y, Uint64 timestamp) {
+    SDL_Event event;
+    SDL_zero(event);
+    event.button.which = which;
+    event.button.button = SDL_BUTTON_LEFT;
+    event.button.x = x;
+    event.button.y = y;
+    event.type = SDL_EVENT_MOUSE_BUTTON_DOWN;
+    event.common.timestamp = timestamp - MS(50);
+    event.button.down = true;
+    CHECK(SDL_PushEvent(&event));
+    event.type = SDL_EVENT_MOUSE_BUTTON_UP;
+    event.common.timestamp = timestamp;
+    event.button.down = false;
+    CHECK(SDL_PushEvent(&event));
+}
+
+// Touch at (x1, y1), lift at (x2, y2) at the given time
+static void gesture(float x1, float y1, float x2, float y2, Uint64 timestamp) {
+    push_finger(SDL_EVENT_FINGER_DOWN, x1, y1, timestamp - MS(80));
+    push_finger(SDL_EVENT_FINGER_UP, x2, y2, timestamp);
+}
+
+// Drain the queue like the main loop; true when any event asked for a redraw
+static bool pump(ui_state_t *ui) {
+    bool redraw = false;
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+        redraw |= ui_handle_event(ui, &event);
+    }
+    return redraw;
+}
+
+static void test_idle(void) {
+    ui_state_t ui;
+    ui_init(&ui, WIDTH, HEIGHT);
+    CHECK_EQ_INT(ui.page, WEATHER_PAGE_CURRENT);
+    CHECK(!pump(&ui));
+    // Nothing to draw: the loop blocks until an event arrives
+    CHECK_EQ_INT(ui_frame_timeout_ms(&ui, T0), -1);
+
+    SDL_Event exposed;
+    SDL_zero(exposed);
+    exposed.type = SDL_EVENT_WINDOW_EXPOSED;
+    exposed.common.timestamp = T0;
+    CHECK(SDL_PushEvent(&exposed));
+    CHECK(pump(&ui));
+    CHECK_EQ_INT(ui_frame_timeout_ms(&ui, T0), 0);
+    ui_frame_presented(&ui, T0 + MS(3));
+    CHECK_EQ_INT(ui_frame_timeout_ms(&ui, T0 + MS(4)), -1);
+    // Not an input: no latency sample
+    CHECK_EQ_INT(ui.latency_count, 0);
+}
+
+static void test_swipes(void) {
+    ui_state_t ui;
+    ui_init(&ui, WIDTH, HEIGHT);
+    Uint64 t = T0;
+
+    // Right to left: next page
+    gesture(250, 120, 100, 125, t);
+    CHECK(pump(&ui));
+    CHECK_EQ_INT(ui.page, WEATHER_PAGE_SUN);
+    CHECK_EQ_INT(ui.direction, 1);
+    CHECK(ui.dirty);
+    ui_frame_presented(&ui, t + MS(5));
+
+    // Wraps around at the last page
+    t += MS(500);
+    gesture(250, 120, 100, 120, t);
+    CHECK(pump(&ui));
+    CHECK_EQ_INT(ui.page, WEATHER_PAGE_CURRENT);
+    ui_frame_presented(&ui, t + MS(5));
+
+    // Left to right: previous page, wrapping backwards
+    t += MS(500);
+    gesture(60, 100, 200, 90, t);
+    CHECK(pump(&ui));
+    CHECK_EQ_INT(ui.page, WEATHER_PAGE_COUNT - 1);
+    CHECK_EQ_INT(ui.direction, -1);
+    ui_frame_presented(&ui, t + MS(5));
+
+    // Mostly vertical, or too short for a swipe and too long for a tap
+    t += MS(500);
+    gesture(160, 20, 200, 200, t);
+    gesture(160, 120, 160 - UI_SWIPE_MIN_PX + 1, 120, t + MS(200));
+    CHECK(!pump(&ui));
+    CHECK_EQ_INT(ui.page, WEATHER_PAGE_COUNT - 1);
+    CHECK(!ui.dirty);
+    CHECK_EQ_INT(ui_frame_timeout_ms(&ui, t + MS(300)), -1);
+}
+
+static void test_tap_detail(void) {
+    ui_state_t ui;
+    ui_init(&ui, WIDTH, HEIGHT);
+    Uint64 t = T0;
+
+    gesture(160, 120, 160 + UI_TAP_MAX_PX, 120 - UI_TAP_MAX_PX, t);
+    CHECK(pump(&ui));
+    CHECK(ui.detail);
+    gesture(160, 120, 162, 121, t + MS(300));
+    CHECK(pump(&ui));
+    CHECK(!ui.detail);
+    gesture(160, 120, 160, 120, t + MS(600));
+    CHECK(pump(&ui));
+    CHECK(ui.detail);
+
+    // A page change leaves the detail view
+    gesture(250, 120, 100, 120, t + MS(900));
+    CHECK(pump(&ui));
+    CHECK(!ui.detail);
+    CHECK_EQ_INT(ui.page, WEATHER_PAGE_SUN);
+    ui_frame_presented(&ui, t + MS(905));
+
+    // A lift without a touch before it is ignored
+    push_finger(SDL_EVENT_FINGER_UP, 160, 120, t + MS(1000));
+    CHECK(!pump(&ui));
+    CHECK(!ui.detail);
+
+    // Mouse events synthesized from touch would count the tap twice
+    push_click(SDL_TOUCH_MOUSEID, 160, 120, t + MS(1200));
+    CHECK(!pump(&ui));
+    CHECK(!ui.detail);
+    // A real mouse works like a finger, in pixels
+    push_click(1, 160, 120, t + MS(1400));
+    CHECK(pump(&ui));
+    CHECK(ui.detail);
+}
+
+static void test_pacing(void) {
+    ui_state_t ui;
+    ui_init(&ui, WIDTH, HEIGHT);
+    Uint64 t = T0;
+    Uint64 frame_ns = SDL_NS_PER_SECOND / PANEL_REFRESH_HZ;
+
+    // First frame right away
+    gesture(160, 120, 160, 120, t);
+    CHECK(pump(&ui));
+    CHECK_EQ_INT(ui_frame_timeout_ms(&ui, t), 0);
+    ui_frame_presented(&ui, t);
+
+    // Input 2 ms after a present waits for the rest of the 16.7 ms frame
+    gesture(160, 120, 160, 120, t + MS(2));
+    CHECK(pump(&ui));
+    CHECK_EQ_INT(ui_frame_timeout_ms(&ui, t + MS(2)), 15);
+    CHECK_EQ_INT(ui_frame_timeout_ms(&ui, t + frame_ns - 1), 1);
+    CHECK_EQ_INT(ui_frame_timeout_ms(&ui, t + frame_ns), 0);
+    CHECK_EQ_INT(ui_frame_timeout_ms(&ui, t + 3 * frame_ns), 0);
+    ui_frame_presented(&ui, t + frame_ns);
+
+    // Idle again after the present
+    CHECK_EQ_INT(ui_frame_timeout_ms(&ui, t + 2 * frame_ns), -1);
+}
+
+static void test_latency(void) {
+    ui_state_t ui;
+    ui_init(&ui, WIDTH, HEIGHT);
+    Uint64 t = T0;
+
+    // Two inputs in one frame: measured from the older one
+    gesture(160, 120, 160, 120, t);
+    gesture(250, 120, 100, 120, t + MS(3));
+    CHECK(pump(&ui));
+    ui_frame_presented(&ui, t + MS(20));
+    CHECK_EQ_INT(ui.latency_count, 1);
+    CHECK_EQ_INT(ui.latency_min_ns, MS(20));
+    CHECK_EQ_INT(ui.pending_input_ns, 0);
+
+    t += SDL_NS_PER_SECOND;
+    gesture(160, 120, 160, 120, t);
+    CHECK(pump(&ui));
+    ui_frame_presented(&ui, t + MS(4));
+    CHECK_EQ_INT(ui.latency_count, 2);
+    CHECK_EQ_INT(ui.latency_min_ns, MS(4));
+    CHECK_EQ_INT(ui.latency_max_ns, MS(20));
+    CHECK_EQ_INT(ui.latency_sum_ns, MS(24));
+
+    // Ignored gestures are not inputs either
+    gesture(160, 20, 170, 200, t + MS(100));
+    CHECK(!pump(&ui));
+    ui_frame_presented(&ui, t + MS(120));
+    CHECK_EQ_INT(ui.latency_count, 2);
+    ui_log_latency(&ui);
+}
+
+static void test_weather_event(void) {
+    ui_state_t ui;
+    ui_init(&ui, WIDTH, HEIGHT);
+
+    // Posted by the scheduler task
+    ui_notify_weather_updated();
+    CHECK(pump(&ui));
+    CHECK(ui.weather_updated);
+    CHECK(ui.dirty);
+    CHECK_EQ_INT(ui_frame_timeout_ms(&ui, T0), 0);
+    ui_frame_presented(&ui, T0);
+    CHECK_EQ_INT(ui.latency_count, 0);
+    CHECK_EQ_INT(ui_frame_timeout_ms(&ui, T0 + MS(1)), -1);
+
+    // Together with a tap both are handled in the same frame
+    ui.weather_updated = false;
+    gesture(160, 120, 160, 120, T0 + MS(100));
+    ui_notify_weather_updated();
+    CHECK(pump(&ui));
+    CHECK(ui.weather_updated);
+    CHECK(ui.detail);
+}
+
+int main(void) {
+    if (!SDL_Init(SDL_INIT_EVENTS)) {
+        fprintf(stderr, "SDL init failed: %s\n", SDL_GetError());
+        return 1;
+    }
+    test_idle();
+    test_swipes();
+    test_tap_detail();
+    test_pacing();
+    test_latency();
+    test_weather_event();
+    SDL_Quit();
+    return CHECK_RESULT();
+}
@@ -0,0 +1,151 @@
+// Widget sandbox limits: the heap cap inside draw() and while its arguments
+// are pushed, and the per-call time budget. A limit that escaped the
+// protected call would end in the Lua panic handler and abort this test.
+#include <string.h>
+#include "check.h"
+#include "lauxlib.h"
+#include "widget_runtime.h"
+
+static esp_err_t load_source(widget_t *widget, const char *name, const char *source) {
+    esp_err_t err = widget_open(widget, name, NULL, 1);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return widget_load(widget, source, strlen(source), "t");
+}
+
+static int push_table(lua_State *L, void *ctx) {
+    lua_createtable(L, 0, 1);
+    lua_pushnumber(L, *(const double *)ctx);
+    lua_setfield(L, -2, "temperature");
+    return 1;
+}
+
+// Argument far larger than the heap cap, built in C like the weather table
+static int push_huge_table(lua_State *L, void *ctx) {
+    (void)ctx;
+    lua_createtable(L, WIDGET_MEMORY_LIMIT, 0);
+    return 1;
+}
+
+// Interned strings: each one allocates until the cap is reached
+static int push_many_strings(lua_State *L, void *ctx) {
+    (void)ctx;
+    lua_newtable(L);
+    for (int i = 0; i < 100000; i++) {
+        lua_pushfstring(L, "field%d", i);
+        lua_rawseti(L, -2, i + 1);
+    }
+    return 1;
+}
+
+static void test_draw_gets_arguments(void) {
+    widget_t widget;
+    CHECK_EQ_INT(load_source(&widget, "args", "function draw(w) seen = w.temperature end"), ESP_OK);
+
+    double temperature = 21.5;
+    CHECK_EQ_INT(widget_draw(&widget, push_table, &temperature), LUA_OK);
+    lua_getglobal(widget.L, "seen");
+    CHECK(lua_tonumber(widget.L, -1) == 21.5);
+    lua_pop(widget.L, 1);
+    CHECK_EQ_INT(widget.stats.errors, 0);
+    CHECK(widget.stats.mem_used > 0 && widget.stats.mem_used <= WIDGET_MEMORY_LIMIT);
+    widget_close(&widget);
+}
+
+static void test_heap_cap_in_draw(void) {
+    widget_t widget;
+    CHECK_EQ_INT(load_source(&widget, "hog",
+                             "function draw() local t = {} for i = 1, 1e6 do t[i] = i end end"), ESP_OK);
+
+    CHECK_EQ_INT(widget_draw(&widget, NULL, NULL), LUA_ERRMEM);
+    CHECK_EQ_INT(widget.stats.errors, 1);
+    CHECK(widget.stats.mem_peak <= WIDGET_MEMORY_LIMIT);
+
+    // The state survives and fails the same way on the next frame
+    CHECK_EQ_INT(widget_draw(&widget, NULL, NULL), LUA_ERRMEM);
+    CHECK_EQ_INT(widget.stats.errors, 2);
+    widget_close(&widget);
+}
+
+static void test_heap_cap_in_arguments(void) {
+    widget_t widget;
+    CHECK_EQ_INT(load_source(&widget, "args_hog", "function draw(w) end"), ESP_OK);
+
+    CHECK_EQ_INT(widget_draw(&widget, push_huge_table, NULL), LUA_ERRMEM);
+    CHECK_EQ_INT(widget_draw(&widget, push_many_strings, NULL), LUA_ERRMEM);
+    CHECK_EQ_INT(widget.stats.errors, 2);
+    CHECK(widget.stats.mem_peak <= WIDGET_MEMORY_LIMIT);
+
+    // Nothing is left on the stack and the widget still draws
+    CHECK_EQ_INT(lua_gettop(widget.L), 0);
+    double temperature = 1.0;
+    CHECK_EQ_INT(widget_draw(&widget, push_table, &temperature), LUA_OK);
+    CHECK_EQ_INT(widget.stats.errors, 0);
+    widget_close(&widget);
+}
+
+static void test_heap_cap_at_load(void) {
+    widget_t widget;
+    CHECK_EQ_INT(load_source(&widget, "big", "blob = string.rep('x', 1e6) function draw() end"), ESP_FAIL);
+    CHECK(widget.stats.mem_peak <= WIDGET_MEMORY_LIMIT);
+    widget_close(&widget);
+}
+
+static void test_time_budget(void) {
+    widget_t widget;
+    CHECK_EQ_INT(load_source(&widget, "spin", "function draw() while true do end end"), ESP_OK);
+    CHECK_EQ_INT(widget.budget_us, WIDGET_MAX_BUDGET_US);
+
+    // Budgets are clamped to the runtime's bounds
+    widget_set_budget(&widget, 0);
+    CHECK_EQ_INT(widget.budget_us, WIDGET_MIN_BUDGET_US);
+    widget_set_budget(&widget, 10 * WIDGET_MAX_BUDGET_US);
+    CHECK_EQ_INT(widget.budget_us, WIDGET_MAX_BUDGET_US);
+
+    // A frame share, e.g. a quarter of 60 Hz split between two widgets
+    const int64_t budget_us = 2000;
+    widget_set_budget(&widget, budget_us);
+    CHECK_EQ_INT(widget_draw(&widget, NULL, NULL), LUA_ERRRUN);
+    printf("spinning draw() stopped after %lld us\n", (long long)widget.stats.wall_us);
+    CHECK(widget.stats.wall_us >= budget_us);
+    // Hook granularity is 1000 instructions; allow for slow sanitizer builds
+    CHECK(widget.stats.wall_us < 10 * budget_us);
+    CHECK_EQ_INT(widget.stats.wall_max_us, widget.stats.wall_us);
+    widget_close(&widget);
+
+    // A top level that never returns is stopped the same way
+    CHECK_EQ_INT(load_source(&widget, "spin_load", "while true do end"), ESP_FAIL);
+    widget_close(&widget);
+}
+
+static void test_rejects_bad_chunks(void) {
+    widget_t widget;
+
+    // The device accepts bytecode only
+    CHECK_EQ_INT(widget_open(&widget, "source", NULL, 1), ESP_OK);
+    const char *source = "function draw() end";
+    CHECK_EQ_INT(widget_load(&widget, source, strlen(source), "b"), ESP_FAIL);
+    widget_close(&widget);
+
+    CHECK_EQ_INT(load_source(&widget, "nodraw", "x = 1"), ESP_FAIL);
+    widget_close(&widget);
+
+    CHECK_EQ_INT(load_source(&widget, "notfunction", "draw = 42"), ESP_FAIL);
+    widget_close(&widget);
+
+    // No io or os in the sandbox
+    CHECK_EQ_INT(load_source(&widget, "io", "function draw() io.write('x') end"), ESP_OK);
+    CHECK_EQ_INT(widget_draw(&widget, NULL, NULL), LUA_ERRRUN);
+    widget_close(&widget);
+}
+
+int main(void) {
+    test_draw_gets_arguments();
+    test_heap_cap_in_draw();
+    test_heap_cap_in_arguments();
+    test_heap_cap_at_load();
+    test_time_budget();
+    test_rejects_bad_chunks();
+    return CHECK_RESULT();
+}
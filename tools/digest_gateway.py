@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+"""Local weather digest gateway for a fleet of displays.
+
+Fetches current weather from OpenWeatherMap once per location and update
+interval, and serves it to displays as a compact fixed-layout binary record
+(see main/weather_digest.h) at:
+
+  GET /digest?q=<city>,<country>
+
+Point a display at the gateway by setting the "gateway" key in nvs.csv to
+"<host>:<port>". Upstream responses can be recorded with --record and
+replayed with --replay, so gateway and device decoder can be exercised on
+Linux without network access. tools/owm_stub_server.py also works as an
+upstream via --upstream-host.
+"""
+
+import argparse
+import glob
+import itertools
+import json
+import os
+import struct
+import threading
+import time
+import urllib.parse
+import urllib.request
+import zlib
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+MAGIC = b"WDGT"
+VERSION = 1
+HEADER_FORMAT = "<4sHHI"
+BODY_FORMAT = "<qqqhHB3x8s64s"
+HEADER_SIZE = struct.calcsize(HEADER_FORMAT)
+RECORD_SIZE = HEADER_SIZE + struct.calcsize(BODY_FORMAT)
+assert RECORD_SIZE == 116
+
+
+def clip_utf8(text, size):
+    """Encode and cut to at most size-1 bytes without splitting a character."""
+    data = text.encode("utf-8")
+    if len(data) < size:
+        return data
+    return data[:size - 1].decode("utf-8", "ignore").encode("utf-8")
+
+
+def temperature(main):
+    """main.temp as the device's JSON parser accepts it, or ValueError."""
+    temp = main.get("temp") if isinstance(main, dict) else None
+    if isinstance(temp, bool) or not isinstance(temp, (int, float)) or not -150.0 <= temp <= 150.0:
+        raise ValueError(f"no usable main.temp in upstream document: {temp!r}")
+    return temp
+
+
+def encode_digest(document):
+    """Normalize an OpenWeatherMap current weather document into a v1 record.
+
+    A document without a temperature is rejected, like weather_json.c does on
+    the device, instead of being served as 0.00 degrees.
+    """
+    weather = (document.get("weather") or [{}])[0]
+    main = document.get("main", {})
+    sys = document.get("sys", {})
+    temp = temperature(main)
+    body = struct.pack(
+        BODY_FORMAT,
+        int(document.get("dt", 0)),
+        int(sys.get("sunrise", 0)),
+        int(sys.get("sunset", 0)),
+        max(-32768, min(32767, round(temp * 100))),
+        max(0, min(65535, int(main.get("pressure", 0)))),
+        max(0, min(255, int(main.get("humidity", 0)))),
+        clip_utf8(weather.get("icon", ""), 8),
+        clip_utf8(weather.get("description", ""), 64),
+    )
+    header = struct.pack(HEADER_FORMAT, MAGIC, VERSION, RECORD_SIZE, zlib.crc32(body))
+    return header + body
+
+
+class Upstream:
+    """One upstream call per location per interval, shared by all displays.
+
+    self.lock guards the cache and counters only; a fetch holds just the lock
+    of its own location, so a slow upstream never delays cache hits or other
+    locations, and concurrent misses for one location share a single call.
+    """
+
+    def __init__(self, args):
+        self.args = args
+        self.cache = {}
+        self.fetching = {}
+        self.lock = threading.Lock()
+        self.calls = 0
+        self.replay = None
+        if args.replay:
+            files = sorted(glob.glob(os.path.join(args.replay, "*.json"))) if os.path.isdir(args.replay) else [args.replay]
+            self.replay = itertools.cycle(files)
+
+    def cached(self, location):
+        with self.lock:
+            cached = self.cache.get(location)
+            if cached and time.time() < cached[0]:
+                return cached[1]
+            return None
+
+    def digest(self, location):
+        record = self.cached(location)
+        if record:
+            return record
+        with self.lock:
+            pending = self.fetching.setdefault(location, threading.Lock())
+        with pending:
+            # Another request may have fetched it while this one waited
+            record = self.cached(location)
+            if record:
+                return record
+            document = self.fetch(location)
+            record = encode_digest(document)
+            # Keep until the provider is expected to publish the next observation
+            now = time.time()
+            dt = int(document.get("dt", now))
+            expires = max(now + self.args.min_ttl, dt + self.args.interval)
+            with self.lock:
+                self.cache[location] = (expires, record)
+            return record
+
+    def fetch(self, location):
+        with self.lock:
+            self.calls += 1
+            path = next(self.replay) if self.replay else None
+        if path:
+            with open(path, "rb") as f:
+                raw = f.read()
+            print(f"upstream replay {path}", flush=True)
+        else:
+            query = urllib.parse.urlencode({"q": location, "appid": self.args.api_key, "units": "metric"})
+            url = f"http://{self.args.upstream_host}/data/2.5/weather?{query}"
+            start = time.monotonic()
+            with urllib.request.urlopen(url, timeout=10) as response:
+                raw = response.read()
+            print(f"upstream {location} {len(raw)} bytes in {(time.monotonic() - start) * 1000:.0f} ms "
+                  f"(calls: {self.calls})", flush=True)
+        if self.args.record:
+            os.makedirs(self.args.record, exist_ok=True)
+            name = f"{int(time.time())}-{location.replace(',', '_')}.json"
+            with open(os.path.join(self.args.record, name), "wb") as f:
+                f.write(raw)
+        return json.loads(raw)
+
+
+class GatewayHandler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def do_GET(self):
+        url = urllib.parse.urlparse(self.path)
+        if url.path != "/digest":
+            self.send_error(404)
+            return
+        location = urllib.parse.parse_qs(url.query).get("q", [""])[0]
+        if not location:
+            self.send_error(400, "missing q=<city>,<country>")
+            return
+        try:
+            record = self.server.upstream.digest(location)
+        except Exception as error:
+            print(f"upstream error for {location}: {error}", flush=True)
+            self.send_error(502)
+            return
+        self.send_response(200)
+        self.send_header("Content-Type", "application/octet-stream")
+        self.send_header("Content-Length", str(len(record)))
+        self.end_headers()
+        self.wfile.write(record)
+
+    def log_message(self, format, *args):
+        print(f"{self.client_address[0]} {format % args}", flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8081)
+    parser.add_argument("--upstream-host", default="api.openweathermap.org")
+    parser.add_argument("--api-key", default=os.environ.get("OPENWEATHER_API_KEY", ""))
+    parser.add_argument("--interval", type=int, default=600, help="provider update cadence in seconds")
+    parser.add_argument("--min-ttl", type=int, default=60, help="minimum cache lifetime in seconds")
+    parser.add_argument("--record", metavar="DIR", help="save every upstream response into DIR")
+    parser.add_argument("--replay", metavar="PATH", help="serve recorded responses (file or directory) instead of upstream")
+    args = parser.parse_args()
+
+    server = ThreadingHTTPServer((args.host, args.port), GatewayHandler)
+    server.upstream = Upstream(args)
+    print(f"Digest gateway on {args.host}:{args.port}, record size {RECORD_SIZE} bytes", flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
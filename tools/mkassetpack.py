@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""Build the read-only asset pack flashed to the "assets" partition.
+
+Layout (little-endian, see main/assetpack.h):
+
+  header   32 bytes   magic "WAPK", version, entry count, index offset,
+                      data offset, total size
+  index    48 bytes per entry, sorted by name for binary search:
+                      name[32], offset, stored size, original size, flags
+  data     entries aligned to ASSET_ALIGN so the device can use them in
+           place from the memory-mapped partition
+
+Entries matching a --compress pattern are stored as raw LZ4 blocks when that
+makes them smaller. Fonts and sprites should stay uncompressed so they can be
+handed to SDL as zero-copy memory streams.
+"""
+
+import argparse
+import fnmatch
+import os
+import struct
+import sys
+
+MAGIC = b"WAPK"
+VERSION = 1
+HEADER_FORMAT = "<4sHHIII12x"
+ENTRY_FORMAT = "<32sIIIHH"
+NAME_MAX = 31
+ASSET_ALIGN = 32
+FLAG_LZ4 = 0x0001
+
+LZ4_MIN_MATCH = 4
+LZ4_LAST_LITERALS = 5
+LZ4_MFLIMIT = 12
+LZ4_MAX_OFFSET = 65535
+
+
+def lz4_length(out, length):
+    while length >= 255:
+        out.append(255)
+        length -= 255
+    out.append(length)
+
+
+def lz4_sequence(out, literals, offset=0, match_length=0):
+    literal_length = len(literals)
+    token = min(literal_length, 15) << 4
+    if offset:
+        token |= min(match_length - LZ4_MIN_MATCH, 15)
+    out.append(token)
+    if literal_length >= 15:
+        lz4_length(out, literal_length - 15)
+    out += literals
+    if offset:
+        out += struct.pack("<H", offset)
+        if match_length - LZ4_MIN_MATCH >= 15:
+            lz4_length(out, match_length - LZ4_MIN_MATCH - 15)
+
+
+def lz4_compress(src):
+    """Greedy LZ4 block compressor, compatible with the reference decoder."""
+    out = bytearray()
+    table = {}
+    anchor = 0
+    i = 0
+    end = len(src)
+    while i < end - LZ4_MFLIMIT:
+        key = src[i:i + LZ4_MIN_MATCH]
+        candidate = table.get(key)
+        table[key] = i
+        if candidate is None or i - candidate > LZ4_MAX_OFFSET:
+            i += 1
+            continue
+        length = LZ4_MIN_MATCH
+        limit = end - LZ4_LAST_LITERALS - i
+        while length < limit and src[candidate + length] == src[i + length]:
+            length += 1
+        lz4_sequence(out, src[anchor:i], i - candidate, length)
+        i += length
+        anchor = i
+    lz4_sequence(out, src[anchor:])
+    return bytes(out)
+
+
+def collect(roots):
+    """Map pack names (relative paths) to host files; later roots win."""
+    files = {}
+    for root in roots:
+        for directory, _, names in os.walk(root):
+            for name in names:
+                path = os.path.join(directory, name)
+                files[os.path.relpath(path, root).replace(os.sep, "/")] = path
+    return files
+
+
+def build(files, compress_patterns):
+    names = sorted(files, key=lambda name: name.encode())
+    entries = []
+    blobs = []
+    for name in names:
+        encoded = name.encode()
+        if len(encoded) > NAME_MAX:
+            sys.exit(f"mkassetpack: name too long (max {NAME_MAX}): {name}")
+        with open(files[name], "rb") as f:
+            data = f.read()
+        flags = 0
+        stored = data
+        if any(fnmatch.fnmatch(name, pattern) for pattern in compress_patterns):
+            packed = lz4_compress(data)
+            if len(packed) < len(data):
+                stored = packed
+                flags |= FLAG_LZ4
+        entries.append([encoded, 0, len(stored), len(data), flags])
+        blobs.append(stored)
+
+    header_size = struct.calcsize(HEADER_FORMAT)
+    index_size = struct.calcsize(ENTRY_FORMAT) * len(entries)
+    offset = align(header_size + index_size)
+    data_offset = offset
+    for entry, blob in zip(entries, blobs):
+        entry[1] = offset
+        offset = align(offset + len(blob))
+    total_size = offset
+
+    image = bytearray(total_size)
+    struct.pack_into(HEADER_FORMAT, image, 0, MAGIC, VERSION, len(entries), header_size, data_offset, total_size)
+    for i, (entry, blob) in enumerate(zip(entries, blobs)):
+        struct.pack_into(ENTRY_FORMAT, image, header_size + i * struct.calcsize(ENTRY_FORMAT), *entry, 0)
+        image[entry[1]:entry[1] + len(blob)] = blob
+    return image, entries
+
+
+def align(value):
+    return (value + ASSET_ALIGN - 1) & ~(ASSET_ALIGN - 1)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-o", "--output", required=True, help="pack image to write")
+    parser.add_argument("-c", "--compress", action="append", default=[], metavar="PATTERN",
+                        help="glob of entry names to store LZ4 compressed (repeatable)")
+    parser.add_argument("--max-size", type=lambda value: int(value, 0), default=0,
+                        help="fail if the image is larger than this (partition size)")
+    parser.add_argument("roots", nargs="+", help="directories whose contents are packed")
+    args = parser.parse_args()
+
+    image, entries = build(collect(args.roots), args.compress)
+    if args.max_size and len(image) > args.max_size:
+        sys.exit(f"mkassetpack: image is {len(image)} bytes, partition holds {args.max_size}")
+
+    with open(args.output, "wb") as f:
+        f.write(image)
+
+    for name, offset, stored, original, flags in entries:
+        kind = "lz4" if flags & FLAG_LZ4 else "raw"
+        print(f"  {name.decode():<32} {kind} {stored:>8} / {original:>8} @ 0x{offset:06x}")
+    print(f"Asset pack: {len(entries)} entries, {len(image)} bytes -> {args.output}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+"""Local stand-in for the OpenWeatherMap current weather API.
+
+Serves /data/2.5/weather with configurable faults and latency so the fetch
+path of the display can be exercised without a cloud account or Internet
+access. Point the device at it by setting the "ow_host" key in nvs.csv to
+"<host>:<port>".
+
+The response shape is selected with --mode, or per request with the "mode"
+query parameter (e.g. /data/2.5/weather?q=Brno,CZ&mode=chunked):
+
+  normal      Content-Length framed JSON
+  chunked     Transfer-Encoding: chunked, small chunks
+  slow        body dripped a few bytes at a time
+  oversized   valid JSON padded well past the device buffer limit
+  truncated   connection closed before Content-Length bytes were sent
+  malformed   200 OK with a body that is not valid JSON
+  wrongtypes  valid JSON with every field but main.temp of the wrong type
+  error       HTTP 500
+
+Every request is logged with its mode, size and time to last byte.
+"""
+
+import argparse
+import json
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import parse_qs, urlparse
+
+MODES = ("normal", "chunked", "slow", "oversized", "truncated", "malformed", "wrongtypes", "error")
+
+
+def weather_json(city, country):
+    now = int(time.time())
+    return {
+        "coord": {"lon": 16.6068, "lat": 49.1952},
+        "weather": [{"id": 803, "main": "Clouds", "description": "broken clouds", "icon": "04d"}],
+        "base": "stations",
+        "main": {"temp": 12.34, "feels_like": 11.2, "temp_min": 10.9, "temp_max": 13.8,
+                 "pressure": 1016, "humidity": 71},
+        "visibility": 10000,
+        "wind": {"speed": 3.6, "deg": 240},
+        "clouds": {"all": 75},
+        # Observations are published on a 10 minute grid
+        "dt": now - now % 600,
+        "sys": {"type": 2, "id": 2000, "country": country, "sunrise": now - 6 * 3600, "sunset": now + 4 * 3600},
+        "timezone": 7200,
+        "id": 3078610,
+        "name": city,
+        "cod": 200,
+    }
+
+
+class StubHandler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def do_GET(self):
+        url = urlparse(self.path)
+        query = parse_qs(url.query)
+        if url.path != "/data/2.5/weather":
+            self.send_error(404)
+            return
+
+        mode = query.get("mode", [self.server.mode])[0]
+        latency_ms = int(query.get("latency", [self.server.latency_ms])[0])
+        location = query.get("q", ["Brno,CZ"])[0].split(",")
+        city = location[0]
+        country = location[1] if len(location) > 1 else ""
+
+        start = time.monotonic()
+        time.sleep(latency_ms / 1000.0)
+
+        body = json.dumps(weather_json(city, country)).encode()
+        try:
+            sent = self.respond(mode, body)
+        except (BrokenPipeError, ConnectionResetError):
+            print(f"{self.client_address[0]} mode={mode} client disconnected", flush=True)
+            return
+
+        elapsed_ms = (time.monotonic() - start) * 1000.0
+        print(f"{self.client_address[0]} mode={mode} bytes={sent} latency={elapsed_ms:.1f}ms", flush=True)
+
+    def respond(self, mode, body):
+        if mode == "error":
+            payload = b'{"cod":500,"message":"internal error"}'
+            self.send_framed(500, payload)
+            return len(payload)
+
+        if mode == "malformed":
+            payload = body[: len(body) // 2] + b"}}]garbage"
+            self.send_framed(200, payload)
+            return len(payload)
+
+        if mode == "wrongtypes":
+            document = json.loads(body)
+            document["dt"] = str(document["dt"])
+            document["weather"] = {"description": 803, "icon": ["04d"]}
+            document["main"]["pressure"] = str(document["main"]["pressure"])
+            document["main"]["humidity"] = None
+            document["sys"]["sunrise"] = "06:12"
+            document["sys"]["sunset"] = {"hour": 20}
+            payload = json.dumps(document).encode()
+            self.send_framed(200, payload)
+            return len(payload)
+
+        if mode == "oversized":
+            document = json.loads(body)
+            document["padding"] = "x" * self.server.oversize
+            payload = json.dumps(document).encode()
+            self.send_framed(200, payload)
+            return len(payload)
+
+        if mode == "truncated":
+            self.send_response(200)
+            self.send_header("Content-Type", "application/json")
+            self.send_header("Content-Length", str(len(body)))
+            self.send_header("Connection", "close")
+            self.end_headers()
+            self.wfile.write(body[: len(body) // 3])
+            self.wfile.flush()
+            self.close_connection = True
+            return len(body) // 3
+
+        if mode == "chunked":
+            self.send_response(200)
+            self.send_header("Content-Type", "application/json")
+            self.send_header("Transfer-Encoding", "chunked")
+            self.end_headers()
+            for offset in range(0, len(body), self.server.chunk_size):
+                chunk = body[offset:offset + self.server.chunk_size]
+                self.wfile.write(b"%x\r\n%s\r\n" % (len(chunk), chunk))
+            self.wfile.write(b"0\r\n\r\n")
+            return len(body)
+
+        if mode == "slow":
+            self.send_response(200)
+            self.send_header("Content-Type", "application/json")
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            for offset in range(0, len(body), self.server.drip_bytes):
+                self.wfile.write(body[offset:offset + self.server.drip_bytes])
+                self.wfile.flush()
+                time.sleep(self.server.drip_ms / 1000.0)
+            return len(body)
+
+        self.send_framed(200, body)
+        return len(body)
+
+    def send_framed(self, status, payload):
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(payload)))
+        self.end_headers()
+        self.wfile.write(payload)
+
+    def log_message(self, format, *args):
+        # Per-request summary is printed by do_GET
+        pass
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--mode", choices=MODES, default="normal", help="default response mode")
+    parser.add_argument("--latency-ms", type=int, default=0, help="delay before the response starts")
+    parser.add_argument("--chunk-size", type=int, default=64, help="chunk size in chunked mode")
+    parser.add_argument("--drip-bytes", type=int, default=16, help="bytes per write in slow mode")
+    parser.add_argument("--drip-ms", type=int, default=100, help="delay between writes in slow mode")
+    parser.add_argument("--oversize", type=int, default=64 * 1024, help="padding added in oversized mode")
+    args = parser.parse_args()
+
+    server = ThreadingHTTPServer((args.host, args.port), StubHandler)
+    server.mode = args.mode
+    server.latency_ms = args.latency_ms
+    server.chunk_size = args.chunk_size
+    server.drip_bytes = args.drip_bytes
+    server.drip_ms = args.drip_ms
+    server.oversize = args.oversize
+
+    print(f"Serving OpenWeatherMap stand-in on {args.host}:{args.port} (mode={args.mode})", flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,18 @@
+-- Daylight progress bar along the bottom edge of the screen
+local BAR_HEIGHT = 6
+
+function draw(weather)
+    local width, height = gfx.size()
+    local y = height - BAR_HEIGHT
+
+    gfx.frame(0, y, width, BAR_HEIGHT, 0, 0, 0)
+
+    local day = weather.sunset - weather.sunrise
+    if day <= 0 then
+        return
+    end
+
+    local progress = (weather.now - weather.sunrise) / day
+    progress = math.max(0, math.min(1, progress))
+    gfx.rect(1, y + 1, (width - 2) * progress, BAR_HEIGHT - 2, 255, 165, 0)
+end
@@ -0,0 +1,13 @@
+-- Vertical humidity gauge on the right edge of the screen
+local GAUGE_WIDTH = 10
+local MARGIN = 20
+
+function draw(weather)
+    local width, height = gfx.size()
+    local x = width - GAUGE_WIDTH - MARGIN
+    local gauge_height = height - 2 * MARGIN
+    local level = math.max(0, math.min(100, weather.humidity)) / 100
+
+    gfx.frame(x, MARGIN, GAUGE_WIDTH, gauge_height, 0, 0, 0)
+    gfx.rect(x + 1, MARGIN + (1 - level) * gauge_height, GAUGE_WIDTH - 2, level * gauge_height - 1, 0, 0, 255)
+end